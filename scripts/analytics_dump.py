@@ -0,0 +1,112 @@
+#!/usr/bin/env python3
+"""
+Reads the visitor counters from a sculpture, see src/analytics.h.
+
+    python3 scripts/analytics_dump.py /dev/ttyACM0              table of the last 24 hours
+    python3 scripts/analytics_dump.py /dev/ttyACM0 --csv        same, as csv
+    python3 scripts/analytics_dump.py /dev/ttyACM0 --raw f.bin  keep the binary dump
+    python3 scripts/analytics_dump.py --file f.bin              read a kept dump
+    python3 scripts/analytics_dump.py /dev/ttyACM0 --clear      start counting afresh
+
+Hours are times of day once the sculpture's clock has been set (upload_cues.py
+--time), otherwise hours since it was powered up. Needs pyserial.
+"""
+
+import argparse
+import os
+import struct
+import sys
+import time
+
+sys.path.insert(0, os.path.dirname(os.path.abspath(__file__)))
+from upload_dataset import Link  # noqa: E402
+
+HOURS = 24
+DWELL_EDGES = [5, 15, 30, 60, 120, 300, 600]  # ANALYTICS_DWELL_EDGES
+HOUR_FORMAT = "<HHHBB"  # HourStats
+SIZE = 2 + HOURS * struct.calcsize(HOUR_FORMAT) + 2 * (len(DWELL_EDGES) + 1)  # sizeof(AnalyticsStats)
+CHUNK = 32  # UPLOAD_MAX_REPLY_DATA
+CLOCK_SET = 0x01
+
+
+def read_dump(link):
+    dump = b""
+    while len(dump) < SIZE:
+        for _ in range(5):
+            status, data = link.request("A", struct.pack("<H", len(dump)))
+            if status == "K" and data:
+                break
+        else:
+            sys.exit("reading at %d failed: %s" % (len(dump), status))
+        dump += data
+    return dump
+
+
+def decode(dump):
+    if len(dump) != SIZE:
+        sys.exit("dump is %d bytes, expected %d" % (len(dump), SIZE))
+    hour, flags = dump[0], dump[1]
+    step = struct.calcsize(HOUR_FORMAT)
+    hours = [struct.unpack_from(HOUR_FORMAT, dump, 2 + i * step) for i in range(HOURS)]
+    dwell = struct.unpack_from("<%dH" % (len(DWELL_EDGES) + 1), dump, 2 + HOURS * step)
+    return hour, flags, hours, dwell
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__, formatter_class=argparse.RawDescriptionHelpFormatter)
+    parser.add_argument("port", nargs="?")
+    parser.add_argument("--file", help="decode a dump kept with --raw instead of reading the sculpture")
+    parser.add_argument("--raw", help="also write the binary dump here")
+    parser.add_argument("--csv", action="store_true")
+    parser.add_argument("--clear", action="store_true")
+    parser.add_argument("--baud", type=int, default=9600)
+    args = parser.parse_args()
+
+    if args.file:
+        with open(args.file, "rb") as f:
+            dump = f.read()
+    elif args.port:
+        link = Link(args.port, args.baud)
+        time.sleep(2.5)  # opening the port resets the Mega
+        if args.clear:
+            status = link.send("A", struct.pack("<H", 0xFFFF))
+            sys.exit(0 if status == "K" else "clear failed: %s" % status)
+        dump = read_dump(link)
+    else:
+        parser.error("a port or --file is needed")
+
+    if args.raw:
+        with open(args.raw, "wb") as f:
+            f.write(dump)
+
+    hour, flags, hours, dwell = decode(dump)
+    order = [(hour + 1 + i) % HOURS for i in range(HOURS)]  # oldest first, the current hour last
+    label = "hour" if flags & CLOCK_SET else "uptime hour"
+
+    if args.csv:
+        print("%s,visits,button0,button1,completed,abandoned" % label.replace(" ", "_"))
+        for h in order:
+            print("%d,%d,%d,%d,%d,%d" % ((h,) + hours[h]))
+        print()
+        print("dwell_from_s,visits")
+        for edge, count in zip([0] + DWELL_EDGES, dwell):
+            print("%d,%d" % (edge, count))
+        return
+
+    print("%-12s %7s %8s %8s %10s %10s" % (label, "visits", "button0", "button1", "completed", "abandoned"))
+    for h in order:
+        visits, b0, b1, completed, abandoned = hours[h]
+        mark = "  <- now" if h == hour else ""
+        print("%-12s %7d %8d %8d %10d %10d%s" % ("%02d:00" % h if flags & CLOCK_SET else h, visits, b0, b1, completed, abandoned, mark))
+    totals = [sum(row[i] for row in hours) for i in range(5)]
+    print("%-12s %7d %8d %8d %10d %10d" % tuple(["24h"] + totals))
+    print()
+    print("dwell time")
+    edges = [0] + DWELL_EDGES
+    for i, count in enumerate(dwell):
+        span = "%ds+" % edges[i] if i == len(dwell) - 1 else "%d-%ds" % (edges[i], edges[i + 1])
+        print("  %-9s %6d" % (span, count))
+
+
+if __name__ == "__main__":
+    main()
@@ -0,0 +1,245 @@
+#!/usr/bin/env python3
+"""
+Assembler for the sculpture's animation programs, see src/animvm.h for the opcodes.
+
+Run by PlatformIO before every build (extra_scripts in platformio.ini), it assembles
+programs/*.anim into src/programs_generated.h, in file name order, which is the order
+playbackProgram picks them by. By hand it lists a program, or uploads it to the
+sculpture's EEPROM, where it is played instead of the built in ones:
+
+    python3 scripts/anim_asm.py programs/ease.anim
+    python3 scripts/anim_asm.py programs/ease.anim --upload /dev/ttyACM0
+    python3 scripts/anim_asm.py --erase /dev/ttyACM0
+    python3 scripts/anim_asm.py --generate
+
+Source is one instruction per line, operands separated by spaces or commas, ';' starts
+a comment and 'name:' labels the next instruction. Registers are r0 - r7, numbers are
+decimal or 0x hex, blend modes are replace, add or max.
+
+    ; ease towards each reading
+            blend replace, 32
+            read r0, done
+    frame:  fill r0
+            wait 1
+            hold frame
+            read r0, done
+            jmp frame
+    done:   end
+"""
+
+import argparse
+import glob
+import os
+import re
+import struct
+import sys
+import time
+
+ROOT = os.path.dirname(os.path.dirname(os.path.abspath(__file__)))
+SOURCE_DIR = os.path.join(ROOT, "programs")
+OUTPUT = os.path.join(ROOT, "src", "programs_generated.h")
+MAX_LEN = 253  # EEPROM_PROGRAM_SIZE - sizeof(ProgramHeader)
+UPLOAD_CHUNK = 32
+
+# name: (opcode, operand kinds), r register, n byte, s signed byte, a address, m blend mode
+OPCODES = {
+    "end": (0, ""),
+    "set": (1, "rn"),
+    "add": (2, "rs"),
+    "fill": (3, "r"),
+    "fade": (4, "n"),
+    "wait": (5, "n"),
+    "loop": (6, "ra"),
+    "read": (7, "ra"),
+    "hold": (8, "a"),
+    "blend": (9, "mn"),
+    "sparkle": (10, "r"),
+    "jmp": (11, "a"),
+}
+BLEND_MODES = {"replace": 0, "add": 1, "max": 2}
+
+
+class AsmError(ValueError):
+    pass
+
+
+def parse_number(text, lo, hi, where):
+    try:
+        value = int(text, 0)
+    except ValueError:
+        raise AsmError("%s: not a number: %r" % (where, text))
+    if not lo <= value <= hi:
+        raise AsmError("%s: %d is out of range %d - %d" % (where, value, lo, hi))
+    return value
+
+
+def assemble(text, name="<program>"):
+    # first pass: labels and instruction sizes
+    lines = []
+    labels = {}
+    addr = 0
+    for lineno, line in enumerate(text.splitlines(), 1):
+        where = "%s:%d" % (name, lineno)
+        line = line.split(";")[0].strip()
+        m = re.match(r"^([A-Za-z_]\w*)\s*:\s*(.*)$", line)
+        if m:
+            if m.group(1) in labels:
+                raise AsmError("%s: label %r defined twice" % (where, m.group(1)))
+            labels[m.group(1)] = addr
+            line = m.group(2).strip()
+        if not line:
+            continue
+        words = line.replace(",", " ").split()
+        mnemonic = words[0].lower()
+        if mnemonic not in OPCODES:
+            raise AsmError("%s: unknown instruction %r" % (where, words[0]))
+        opcode, kinds = OPCODES[mnemonic]
+        if len(words) - 1 != len(kinds):
+            raise AsmError("%s: %s takes %d operands" % (where, mnemonic, len(kinds)))
+        lines.append((where, opcode, kinds, words[1:]))
+        addr += 1 + len(kinds)
+
+    if addr > MAX_LEN:
+        raise AsmError("%s: %d bytes, the most is %d" % (name, addr, MAX_LEN))
+
+    # second pass: encode
+    code = []
+    for where, opcode, kinds, operands in lines:
+        code.append(opcode)
+        for kind, operand in zip(kinds, operands):
+            if kind == "r":
+                m = re.match(r"^[rR]([0-7])$", operand)
+                if not m:
+                    raise AsmError("%s: not a register: %r" % (where, operand))
+                code.append(int(m.group(1)))
+            elif kind == "n":
+                code.append(parse_number(operand, 0, 255, where))
+            elif kind == "s":
+                code.append(parse_number(operand, -128, 127, where) & 0xFF)
+            elif kind == "m":
+                if operand.lower() not in BLEND_MODES:
+                    raise AsmError("%s: unknown blend mode %r" % (where, operand))
+                code.append(BLEND_MODES[operand.lower()])
+            else:  # address
+                if operand in labels:
+                    code.append(labels[operand])
+                else:
+                    code.append(parse_number(operand, 0, addr - 1, where))
+    return bytes(code)
+
+
+def generate():
+    paths = sorted(glob.glob(os.path.join(SOURCE_DIR, "*.anim")))
+    if not paths:
+        raise AsmError("no programs in %s" % os.path.relpath(SOURCE_DIR, ROOT))
+    out = [
+        "// Generated by scripts/anim_asm.py from programs/*.anim, do not edit.",
+        "",
+        "#pragma once",
+        "",
+        "struct AnimProgram",
+        "{",
+        "    const uint8_t *code;",
+        "    uint16_t len;",
+        "};",
+        "",
+    ]
+    names = []
+    for path in paths:
+        name = os.path.splitext(os.path.basename(path))[0].upper()
+        if not re.match(r"^[A-Z_][A-Z0-9_]*$", name):
+            raise AsmError("%s: file name must be a valid C identifier" % path)
+        with open(path) as f:
+            code = assemble(f.read(), os.path.relpath(path, ROOT))
+        names.append((name, len(code)))
+        out.append("// %s, %d bytes" % (os.path.basename(path), len(code)))
+        out.append("const uint8_t %s_CODE[%d] PROGMEM = {%s};" % (name, len(code), ", ".join(str(b) for b in code)))
+        out.append("")
+    out.append("const AnimProgram ANIM_PROGRAMS[%d] PROGMEM = {%s};" % (len(names), ", ".join("{%s_CODE, %d}" % n for n in names)))
+    out.append("const uint8_t NUM_ANIM_PROGRAMS = %d;" % len(names))
+    out.append("")
+    text = "\n".join(out)
+
+    old = None
+    if os.path.exists(OUTPUT):
+        with open(OUTPUT) as f:
+            old = f.read()
+    if text != old:  # leave the file alone so it does not trigger a rebuild
+        with open(OUTPUT, "w") as f:
+            f.write(text)
+        print("anim_asm: wrote %s from %d programs" % (os.path.relpath(OUTPUT, ROOT), len(names)))
+
+
+def upload(port, baud, code):
+    # frames as in upload.h, 'Q' with the length marks the program valid, 'Q' 0 erases it
+    sys.path.insert(0, os.path.dirname(os.path.abspath(__file__)))
+    from upload_dataset import Link
+
+    link = Link(port, baud)
+    time.sleep(2.5)  # opening the port resets the Mega
+
+    status = link.send("Q", struct.pack("<H", 0))
+    if status != "K":
+        sys.exit("erase refused: %s" % status)
+    for offset in range(0, len(code), UPLOAD_CHUNK):
+        for _ in range(5):
+            status = link.send("P", struct.pack("<H", offset) + code[offset:offset + UPLOAD_CHUNK])
+            if status == "K":
+                break
+        else:
+            sys.exit("program frame at %d failed: %s" % (offset, status))
+    if code:
+        status = link.send("Q", struct.pack("<H", len(code)))
+        if status != "K":
+            sys.exit("end refused: %s" % status)
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__, formatter_class=argparse.RawDescriptionHelpFormatter)
+    parser.add_argument("source", nargs="?")
+    parser.add_argument("--upload", metavar="PORT", help="store the program in the sculpture's EEPROM")
+    parser.add_argument("--erase", metavar="PORT", help="remove the stored program, back to the built in ones")
+    parser.add_argument("--generate", action="store_true", help="assemble programs/ into src/programs_generated.h")
+    parser.add_argument("--baud", type=int, default=9600)
+    args = parser.parse_args()
+
+    if args.generate:
+        generate_or_exit()
+        return
+    if args.erase:
+        upload(args.erase, args.baud, b"")
+        print("stored program erased")
+        return
+    if not args.source:
+        parser.error("no program given")
+
+    try:
+        with open(args.source) as f:
+            code = assemble(f.read(), args.source)
+    except AsmError as e:
+        sys.exit(str(e))
+
+    print("%d bytes: %s" % (len(code), " ".join("%02x" % b for b in code)))
+    if args.upload:
+        upload(args.upload, args.baud, code)
+        print("uploaded to EEPROM")
+
+
+def generate_or_exit():
+    try:
+        generate()
+    except AsmError as e:
+        sys.stderr.write("anim_asm: %s\n" % e)
+        sys.exit(1)
+
+
+try:
+    Import("env")  # noqa: F821, run by PlatformIO
+    IS_PLATFORMIO = True
+except NameError:
+    IS_PLATFORMIO = False
+
+if IS_PLATFORMIO:
+    generate_or_exit()
+elif __name__ == "__main__":
+    main()
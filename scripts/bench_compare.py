@@ -0,0 +1,52 @@
+#!/usr/bin/env python3
+"""
+Compares two runs of the bench build (see src/bench/bench.cpp), e.g. before and after a
+FastLED upgrade.
+
+    python3 scripts/bench_compare.py old.csv new.csv
+    python3 scripts/bench_compare.py old.csv new.csv --over 5   only changes over 5%
+
+The files are the serial output saved as is, from a board or simavr. Lines that are not
+table rows are skipped, so monitor or simavr prefixes do not matter.
+"""
+
+import argparse
+import re
+import sys
+
+ROW = re.compile(r"([A-Za-z_][A-Za-z0-9_]*),(\d+),(\d+),([\d.]+),(\d+)\s*$")
+
+
+def read_table(path):
+    table = {}
+    with open(path, errors="replace") as f:
+        for line in f:
+            match = ROW.search(line)
+            if match:
+                table[(match.group(1), int(match.group(2)))] = int(match.group(3))
+    if not table:
+        sys.exit("%s has no bench rows" % path)
+    return table
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__, formatter_class=argparse.RawDescriptionHelpFormatter)
+    parser.add_argument("old")
+    parser.add_argument("new")
+    parser.add_argument("--over", type=float, default=0, help="only show changes over this many percent")
+    args = parser.parse_args()
+
+    old, new = read_table(args.old), read_table(args.new)
+
+    print("%-16s %5s %10s %10s %8s" % ("name", "size", "old", "new", "change"))
+    for key in sorted(set(old) | set(new)):
+        if key not in old or key not in new:
+            print("%-16s %5d %10s %10s" % (key[0], key[1], old.get(key, "-"), new.get(key, "-")))
+            continue
+        change = 100.0 * (new[key] - old[key]) / old[key] if old[key] else 0.0
+        if abs(change) >= args.over:
+            print("%-16s %5d %10d %10d %+7.1f%%" % (key[0], key[1], old[key], new[key], change))
+
+
+if __name__ == "__main__":
+    main()
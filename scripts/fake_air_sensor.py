@@ -0,0 +1,147 @@
+#!/usr/bin/env python3
+"""
+Stands in for the live air quality sensor of src/livesensor.h on Serial1, so live mode
+and the parser can be tried without one. Prints every frame as it is sent.
+
+    python3 scripts/fake_air_sensor.py mhz19                      print a pty path to attach to
+    python3 scripts/fake_air_sensor.py sds011 --faults 0.3        one frame in three has a fault
+    python3 scripts/fake_air_sensor.py mhz19 --port /dev/ttyUSB0  on a USB serial adapter wired
+                                                                  to the sculpture's pins 18 and 19
+
+mhz19 answers the sculpture's read command, FF 01 86 00 00 00 00 00 79, with
+FF 86 HI LO 00 00 00 00 CS. sds011 sends AA C0 PM25LO PM25HI PM10LO PM10HI ID ID CS AB
+once a second on its own, PM in tenths of ug/m3. The reading wanders around --value.
+
+--faults is the fraction of frames sent with one of these, picked in turn, which the
+parser must get past without losing the next good frame:
+    checksum   wrong checksum, must be dropped
+    header     a stray header byte just before the frame (FF FF 86 .., AA AA C0 ..)
+    noise      a few random bytes before the frame
+    cut        the frame stops half way and the next one follows straight on, so the
+               parser takes the next one into the cut one and drops both
+    split      the frame goes out in two writes 30ms apart
+--stop-after stops sending after that many seconds, to watch live mode end
+(LIVE_TIMEOUT). --port needs pyserial.
+"""
+
+import argparse
+import os
+import random
+import select
+import time
+import tty
+
+MHZ19_READ_CMD = bytes([0xFF, 0x01, 0x86, 0x00, 0x00, 0x00, 0x00, 0x00, 0x79])
+FAULTS = ["checksum", "header", "noise", "cut", "split"]
+
+
+def mhz19_frame(ppm, bad=False):
+    frame = bytearray([0xFF, 0x86, ppm >> 8, ppm & 0xFF, 0, 0, 0, 0, 0])
+    frame[8] = -sum(frame[1:8]) & 0xFF
+    if bad:
+        frame[8] ^= 0x01
+    return bytes(frame)
+
+
+def sds011_frame(tenths, bad=False):
+    frame = bytearray([0xAA, 0xC0, tenths & 0xFF, tenths >> 8, tenths & 0xFF, tenths >> 8, 0x12, 0x34, 0, 0xAB])
+    frame[8] = sum(frame[2:8]) & 0xFF
+    if bad:
+        frame[8] ^= 0x01
+    return bytes(frame)
+
+
+class Sensor:
+    def __init__(self, kind, value, faults, write):
+        self.kind, self.value, self.centre, self.faults, self.write = kind, value, value, faults, write
+        self.next_fault = 0
+        self.sent = {"good": 0, "dropped": 0}
+
+    def reading(self):
+        """Random walk pulled back towards the centre value"""
+        self.value += random.randint(-20, 20) + (self.centre - self.value) // 10
+        self.value = max(0, min(self.value, 0xFFFF))
+        return self.value
+
+    def units(self, value):
+        return "%d ppm" % value if self.kind == "mhz19" else "%.1f ug/m3" % (value / 10.0)
+
+    def send(self, now):
+        value = self.reading()
+        fault = None
+        if random.random() < self.faults:
+            fault = FAULTS[self.next_fault]
+            self.next_fault = (self.next_fault + 1) % len(FAULTS)
+
+        make = mhz19_frame if self.kind == "mhz19" else sds011_frame
+        frame = make(value, fault == "checksum")
+        note = ""
+        if fault == "header":
+            self.write(frame[:1])
+        elif fault == "noise":
+            noise = bytes(random.randint(0, 255) for _ in range(random.randint(1, 4)))
+            self.write(noise)
+            note = " after %s" % noise.hex(" ")
+        elif fault == "cut":
+            self.write(frame[:len(frame) // 2])
+            value = self.reading()
+            frame = make(value)
+            self.sent["dropped"] += 1
+            note = ", the next frame follows into it"
+        elif fault == "split":
+            self.write(frame[:4])
+            time.sleep(0.03)
+            frame = frame[4:]
+
+        self.write(frame)
+        dropped = fault in ("checksum", "cut")
+        self.sent["dropped" if dropped else "good"] += 1
+        print("%8.3f %s%s%s" % (now, self.units(value), " (%s)" % fault if fault else "", note), flush=True)
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__, formatter_class=argparse.RawDescriptionHelpFormatter)
+    parser.add_argument("sensor", choices=["mhz19", "sds011"])
+    parser.add_argument("--port", help="real serial port, else a pty is made")
+    parser.add_argument("--value", type=int, help="reading to wander around, ppm or tenths of ug/m3")
+    parser.add_argument("--faults", type=float, default=0.0, help="fraction of frames with a fault, 0 - 1")
+    parser.add_argument("--stop-after", type=float, default=0, help="seconds, 0 never stops")
+    args = parser.parse_args()
+
+    if args.port:
+        import serial  # pyserial, only needed for real ports
+
+        port = serial.Serial(args.port, 9600, timeout=0)
+        fd, read, write = port.fileno(), lambda: port.read(256), port.write
+    else:
+        fd, slave = os.openpty()
+        tty.setraw(slave)
+        print("sensor on %s" % os.ttyname(slave), flush=True)
+        read, write = (lambda: os.read(fd, 256)), (lambda data: os.write(fd, data))
+
+    value = args.value if args.value is not None else (800 if args.sensor == "mhz19" else 350)
+    sensor = Sensor(args.sensor, value, args.faults, write)
+    start = time.monotonic()
+    command, next_send = b"", start + 1
+    try:
+        while not args.stop_after or time.monotonic() - start < args.stop_after:
+            readable, _, _ = select.select([fd], [], [], 0.05)
+            now = time.monotonic()
+            if readable:
+                command = (command + read())[-len(MHZ19_READ_CMD):]
+                if args.sensor == "mhz19" and command == MHZ19_READ_CMD:
+                    command = b""
+                    sensor.send(now - start)
+            if args.sensor == "sds011" and now >= next_send:
+                next_send += 1
+                sensor.send(now - start)
+        print("stopped sending")
+        while True:
+            time.sleep(1)
+    except KeyboardInterrupt:
+        pass
+    print("%d good frames, %d the parser should drop" % (sensor.sent["good"], sensor.sent["dropped"]))
+
+
+if __name__ == "__main__":
+    main()
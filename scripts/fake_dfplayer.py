@@ -0,0 +1,109 @@
+#!/usr/bin/env python3
+"""
+Stands in for the DFPlayer style MP3 module of src/audio.h. Prints each command as it
+is understood and answers like the module: an ack for every command that asks for one,
+and a track finished message (sent twice, as the module does) when a track has played.
+A track with loop on starts again instead.
+
+    python3 scripts/fake_dfplayer.py                      print a pty path to attach to
+    python3 scripts/fake_dfplayer.py --port /dev/ttyUSB0  on a USB serial adapter wired
+                                                          to the sculpture's pins 10 and 11
+
+--track-seconds sets how long every track plays. --port needs pyserial. A pty does not
+lose bytes while FastLED.show() has interrupts off, the reason the sculpture reads
+nothing back, so it shows what is sent and when, not what a module would hear.
+"""
+
+import argparse
+import os
+import select
+import time
+import tty
+
+FRAME_LEN = 10
+NAMES = {0x03: "play", 0x06: "volume", 0x0E: "pause", 0x0D: "resume", 0x0F: "play folder", 0x16: "stop", 0x19: "loop"}
+
+
+def checksum(frame):
+    return -sum(frame[1:7]) & 0xFFFF
+
+
+def make_frame(cmd, param=0):
+    frame = bytearray([0x7E, 0xFF, 0x06, cmd, 0x00, param >> 8, param & 0xFF, 0, 0, 0xEF])
+    frame[7], frame[8] = checksum(frame) >> 8, checksum(frame) & 0xFF
+    return bytes(frame)
+
+
+class Parser:
+    """Byte at a time, as audio_parse_byte()"""
+
+    def __init__(self):
+        self.frame = b""
+
+    def feed(self, data):
+        frames = []
+        for c in data:
+            if not self.frame and c != 0x7E:
+                continue
+            self.frame += bytes([c])
+            if len(self.frame) == FRAME_LEN:
+                frame, self.frame = self.frame, b""
+                if frame[9] == 0xEF and (frame[7] << 8 | frame[8]) == checksum(frame):
+                    frames.append(frame)
+                else:
+                    print("bad frame %s" % frame.hex(" "))
+        return frames
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__, formatter_class=argparse.RawDescriptionHelpFormatter)
+    parser.add_argument("--port", help="real serial port, else a pty is made")
+    parser.add_argument("--track-seconds", type=float, default=10.0)
+    args = parser.parse_args()
+
+    if args.port:
+        import serial  # pyserial, only needed for real ports
+
+        port = serial.Serial(args.port, 9600, timeout=0)
+        fd, read, write = port.fileno(), lambda: port.read(256), port.write
+    else:
+        fd, slave = os.openpty()
+        tty.setraw(slave)
+        print("module on %s" % os.ttyname(slave), flush=True)
+        read, write = (lambda: os.read(fd, 256)), (lambda data: os.write(fd, data))
+
+    frames = Parser()
+    start = time.monotonic()
+    playing, track_end, looping = None, 0, False
+    while True:
+        readable, _, _ = select.select([fd], [], [], 0.05)
+        now = time.monotonic()
+        if readable:
+            for frame in frames.feed(read()):
+                cmd, wants_ack, param = frame[3], frame[4], frame[5] << 8 | frame[6]
+                name = NAMES.get(cmd, "command 0x%02X" % cmd)
+                if cmd == 0x0F:
+                    print("%8.3f %s %02d/%03d" % (now - start, name, param >> 8, param & 0xFF))
+                    playing, track_end = param, now + args.track_seconds
+                elif cmd == 0x19:
+                    looping = param == 0
+                    print("%8.3f %s %s" % (now - start, name, "on" if looping else "off"))
+                else:
+                    print("%8.3f %s %d" % (now - start, name, param))
+                if wants_ack:
+                    write(make_frame(0x41))
+        if playing is not None and now >= track_end:
+            if looping:
+                print("%8.3f looped %02d/%03d" % (now - start, playing >> 8, playing & 0xFF))
+                track_end = now + args.track_seconds
+                continue
+            print("%8.3f finished %02d/%03d" % (now - start, playing >> 8, playing & 0xFF))
+            write(make_frame(0x3D, playing & 0xFF) * 2)
+            playing = None
+
+
+if __name__ == "__main__":
+    try:
+        main()
+    except KeyboardInterrupt:
+        pass
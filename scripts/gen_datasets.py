@@ -0,0 +1,144 @@
+#!/usr/bin/env python3
+"""
+Compiles datasets/*.csv into src/datasets_generated.h: one flash table of pre-scaled
+brightness values per csv, plus its length, source range and units, so the sculpture
+does no conversion at boot or during playback. The data sets are also gathered into
+one catalogue per sculpture and button, e.g. CO2_CATALOGUE0, which a button press
+cycles through in file name order.
+
+Runs before every PlatformIO build (extra_scripts in platformio.ini) and can also be
+run by hand. Each csv looks like
+
+    # sculpture: CO2         CO2, PM25 or VOC
+    # button: 0              0 or 1
+    # units: ppm
+    # range: 0 1800          raw data range
+    # brightness: 64 255     brightness range it is mapped to, as Arduino map()
+    reading
+    1609
+    577
+
+Comment lines without a key and non numeric rows (headers) are skipped. If there are
+several columns the last one is used. The table is named after the file, so
+co2_1.csv becomes CO2_1.
+"""
+
+import glob
+import os
+import re
+import sys
+
+ROOT = os.path.dirname(os.path.dirname(os.path.abspath(__file__)))
+SOURCE_DIR = os.path.join(ROOT, "datasets")
+OUTPUT = os.path.join(ROOT, "src", "datasets_generated.h")
+
+
+def arduino_map(x, in_min, in_max, out_min, out_max):
+    # same integer maths as Arduino's map(), which truncates towards zero
+    num = (x - in_min) * (out_max - out_min)
+    den = in_max - in_min
+    q = abs(num) // abs(den)
+    if (num < 0) != (den < 0):
+        q = -q
+    return q + out_min
+
+
+def parse_csv(path):
+    meta = {"units": ""}
+    values = []
+    with open(path) as f:
+        for lineno, line in enumerate(f, 1):
+            line = line.strip()
+            if not line:
+                continue
+            if line.startswith("#"):
+                m = re.match(r"#\s*(\w+)\s*:\s*(.*)$", line)
+                if m:
+                    meta[m.group(1).lower()] = m.group(2).strip()
+                continue
+            field = line.split(",")[-1].strip()
+            try:
+                values.append(int(round(float(field))))
+            except ValueError:
+                if values:
+                    raise ValueError("%s:%d: not a number: %r" % (path, lineno, field))
+    for key in ("sculpture", "button", "range", "brightness"):
+        if key not in meta:
+            raise ValueError("%s: missing '# %s: MIN MAX'" % (path, key))
+    in_min, in_max = [int(x) for x in meta["range"].split()]
+    out_min, out_max = [int(x) for x in meta["brightness"].split()]
+    if in_min == in_max:
+        raise ValueError("%s: empty range" % path)
+    if not values:
+        raise ValueError("%s: no readings" % path)
+    if not (0 <= out_min <= 255 and 0 <= out_max <= 255):
+        raise ValueError("%s: brightness must be within 0 255" % path)
+    sculpture = meta["sculpture"].upper()
+    if sculpture not in ("CO2", "PM25", "VOC"):
+        raise ValueError("%s: unknown sculpture %r" % (path, meta["sculpture"]))
+    if meta["button"] not in ("0", "1"):
+        raise ValueError("%s: button must be 0 or 1" % path)
+    return sculpture, int(meta["button"]), meta["units"], in_min, in_max, out_min, out_max, values
+
+
+def generate():
+    paths = sorted(glob.glob(os.path.join(SOURCE_DIR, "*.csv")))
+    catalogues = {}
+    out = [
+        "// Generated by scripts/gen_datasets.py from datasets/*.csv, do not edit.",
+        "",
+        "#pragma once",
+        "",
+        "struct FlashDataset",
+        "{",
+        "    const uint8_t *values; //brightness values, already mapped",
+        "    uint16_t len;",
+        "    int16_t inMin, inMax;  //range of the raw data",
+        "    uint8_t outMin, outMax; //brightness range it was mapped to",
+        "    const char *units;     //in flash",
+        "};",
+        "",
+    ]
+    for path in paths:
+        name = os.path.splitext(os.path.basename(path))[0].upper()
+        if not re.match(r"^[A-Z_][A-Z0-9_]*$", name):
+            raise ValueError("%s: file name must be a valid C identifier" % path)
+        sculpture, button, units, in_min, in_max, out_min, out_max, values = parse_csv(path)
+        catalogues.setdefault("%s_CATALOGUE%d" % (sculpture, button), []).append(name)
+        bright = [max(0, min(255, arduino_map(v, in_min, in_max, out_min, out_max))) for v in values]
+        rows = [", ".join(str(b) for b in bright[i:i + 20]) for i in range(0, len(bright), 20)]
+        out.append("// %s, %d readings, %s %d-%d mapped to %d-%d" % (os.path.basename(path), len(values), units or "raw", in_min, in_max, out_min, out_max))
+        out.append("const uint8_t %s_VALUES[%d] PROGMEM = {\n    %s};" % (name, len(bright), ",\n    ".join(rows)))
+        out.append('const char %s_UNITS[] PROGMEM = "%s";' % (name, units))
+        out.append("const FlashDataset %s PROGMEM = {%s_VALUES, %d, %d, %d, %d, %d, %s_UNITS};" % (name, name, len(bright), in_min, in_max, out_min, out_max, name))
+        out.append("")
+    for sculpture in ("CO2", "PM25", "VOC"):
+        for button in (0, 1):
+            catalogue = "%s_CATALOGUE%d" % (sculpture, button)
+            if catalogue not in catalogues:
+                raise ValueError("no data set for %s button %d" % (sculpture, button))
+            entries = catalogues[catalogue]
+            out.append("const FlashDataset *const %s[%d] PROGMEM = {%s};" % (catalogue, len(entries), ", ".join("&" + e for e in entries)))
+    out.append("")
+    text = "\n".join(out)
+
+    old = None
+    if os.path.exists(OUTPUT):
+        with open(OUTPUT) as f:
+            old = f.read()
+    if text != old:  # leave the file alone so it does not trigger a rebuild
+        with open(OUTPUT, "w") as f:
+            f.write(text)
+        print("gen_datasets: wrote %s from %d data sets" % (os.path.relpath(OUTPUT, ROOT), len(paths)))
+
+
+try:
+    Import("env")  # noqa: F821, run by PlatformIO
+except NameError:
+    pass
+
+try:
+    generate()
+except ValueError as e:
+    sys.stderr.write("gen_datasets: %s\n" % e)
+    sys.exit(1)
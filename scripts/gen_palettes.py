@@ -0,0 +1,86 @@
+#!/usr/bin/env python3
+"""
+Upscales the 16 entry colour palettes below to 256 entry flash tables in
+src/palettes_generated.h, e.g. AIR_QUALITY_PALETTE, 3 bytes (r, g, b) per entry.
+Playback looks a reading's colour up with one indexed flash read instead of the
+interpolation ColorFromPalette() does on a CRGBPalette16 every time.
+
+The upscaling is the same integer maths as FastLED's ColorFromPalette() with
+LINEARBLEND, except that the last entry does not blend back into the first, as
+readings are not cyclic.
+
+Runs before every PlatformIO build (extra_scripts in platformio.ini) and can also be
+run by hand. Each sculpture picks its palette in src/profiles.h.
+"""
+
+import os
+
+ROOT = os.path.dirname(os.path.dirname(os.path.abspath(__file__)))
+OUTPUT = os.path.join(ROOT, "src", "palettes_generated.h")
+
+# 16 entries each, as CRGBPalette16, from the lowest reading to the highest
+PALETTES = {
+    # green, amber, red
+    "AIR_QUALITY": [
+        0x00FF00, 0x20FF00, 0x40FF00, 0x60FF00, 0x80FF00, 0xA0F000, 0xC0E000, 0xE0C800,
+        0xFFB000, 0xFF9800, 0xFF8000, 0xFF6000, 0xFF4000, 0xFF2800, 0xFF1000, 0xFF0000,
+    ],
+    # US AQI bands: green, yellow, orange, red, purple
+    "AQI": [
+        0x00E400, 0x40E800, 0x80F000, 0xC0F800, 0xFFFF00, 0xFFD800, 0xFFB000, 0xFF7E00,
+        0xFF5000, 0xFF2000, 0xFF0000, 0xD00030, 0xA00060, 0x8F3F97, 0x80208C, 0x7E0080,
+    ],
+}
+
+
+def scale8(i, scale):
+    # FastLED scale8() with FASTLED_SCALE8_FIXED, its default
+    return (i * (1 + scale)) >> 8
+
+
+def upscale(palette16):
+    out = []
+    for index in range(256):
+        hi4, lo4 = index >> 4, index & 0x0F
+        rgb1 = [(palette16[hi4] >> shift) & 0xFF for shift in (16, 8, 0)]
+        if lo4 and hi4 < 15:
+            rgb2 = [(palette16[hi4 + 1] >> shift) & 0xFF for shift in (16, 8, 0)]
+            f2 = lo4 << 4
+            f1 = 255 - f2
+            rgb1 = [scale8(a, f1) + scale8(b, f2) for a, b in zip(rgb1, rgb2)]
+        out.append(rgb1)
+    return out
+
+
+def generate():
+    out = [
+        "// Generated by scripts/gen_palettes.py, do not edit.",
+        "",
+        "#pragma once",
+        "",
+    ]
+    for name, palette16 in PALETTES.items():
+        if len(palette16) != 16:
+            raise ValueError("%s: palette needs 16 entries, has %d" % (name, len(palette16)))
+        entries = upscale(palette16)
+        rows = [", ".join("%d, %d, %d" % tuple(e) for e in entries[i:i + 8]) for i in range(0, 256, 8)]
+        out.append("const uint8_t %s_PALETTE[256 * 3] PROGMEM = {\n    %s};" % (name, ",\n    ".join(rows)))
+        out.append("")
+    text = "\n".join(out)
+
+    old = None
+    if os.path.exists(OUTPUT):
+        with open(OUTPUT) as f:
+            old = f.read()
+    if text != old:  # leave the file alone so it does not trigger a rebuild
+        with open(OUTPUT, "w") as f:
+            f.write(text)
+        print("gen_palettes: wrote %s from %d palettes" % (os.path.relpath(OUTPUT, ROOT), len(PALETTES)))
+
+
+try:
+    Import("env")  # noqa: F821, run by PlatformIO
+except NameError:
+    pass
+
+generate()
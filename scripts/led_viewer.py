@@ -0,0 +1,212 @@
+#!/usr/bin/env python3
+"""
+Shows what a sculpture's strips are showing, from the frames it dumps after
+"view on" (see src/viewer.h), so animation changes can be reviewed at the desk.
+
+    python3 scripts/led_viewer.py /dev/ttyACM0 --term              live, in a truecolour terminal
+    python3 scripts/led_viewer.py /dev/ttyACM0 --out frames         frames/frame_00000.ppm, ...
+    python3 scripts/led_viewer.py /dev/ttyACM0 --out frames --png   same as png
+    python3 scripts/led_viewer.py /dev/ttyACM0 --capture f.bin      keep the raw dump
+    python3 scripts/led_viewer.py --file f.bin --out frames         render a kept dump
+
+Each data pin (leds0..leds3) is a row, each led a square. Under them a bar shows the
+frame's time in loop() against the 1000000 / framesPerSecond budget, green, amber
+over 75%, red over budget, with the microseconds. --out also writes frames.csv with
+the times. Colours are scaled by the frame's brightness like FastLED.show() does.
+The sculpture keeps its frame rate while viewing and about 2 of its frames a second
+get through, the frame numbers show the ones skipped. Needs pyserial for a port.
+"""
+
+import argparse
+import os
+import struct
+import sys
+import time
+import zlib
+
+sys.path.insert(0, os.path.dirname(os.path.abspath(__file__)))
+from upload_dataset import SOF, crc8  # noqa: E402
+
+VIEW_TYPE = ord("V")
+HEADER_FORMAT = "<BHIHBBB"  # type, frame, ms, frame us, fps, brightness, pins
+HEADER_SIZE = struct.calcsize(HEADER_FORMAT)
+GAP = 2  # pixels between rows
+BAR_HEIGHT = 7
+
+DIGITS = [  # 3x5, rows top down
+    "111101101101111", "010110010010111", "111001111100111", "111001111001111", "101101111001001",
+    "111100111001111", "111100111101111", "111001001001001", "111101111101111", "111101111001111",
+]
+
+
+class Frame:
+    def __init__(self, number, ms, us, fps, brightness, rows):
+        self.number, self.ms, self.us, self.fps, self.brightness, self.rows = number, ms, us, fps, brightness, rows
+
+    def budget_us(self):
+        return 1000000 // max(self.fps, 1)
+
+
+def parse_frames(buf):
+    """Returns the frames in buf and the bytes left over that may start one"""
+    frames = []
+    while True:
+        i = buf.find(bytes([SOF]))
+        if i < 0:
+            return frames, b""
+        buf = buf[i:]
+        if len(buf) < 1 + HEADER_SIZE:
+            return frames, buf
+        ftype, number, ms, us, fps, brightness, pins = struct.unpack_from(HEADER_FORMAT, buf, 1)
+        if ftype != VIEW_TYPE:
+            buf = buf[1:]
+            continue
+        sizes = buf[1 + HEADER_SIZE:1 + HEADER_SIZE + pins]
+        if len(sizes) < pins:
+            return frames, buf
+        end = 1 + HEADER_SIZE + pins + 3 * sum(sizes)
+        if len(buf) < end + 1:
+            return frames, buf
+        if crc8(buf[1:end]) != buf[end]:
+            buf = buf[1:]  # text got into it, or not a frame
+            continue
+        rows, pos = [], 1 + HEADER_SIZE + pins
+        for size in sizes:
+            rows.append([tuple(buf[pos + 3 * j:pos + 3 * j + 3]) for j in range(size)])
+            pos += 3 * size
+        frames.append(Frame(number, ms, us, fps, brightness, rows))
+        buf = buf[end + 1:]
+
+
+def scale(colour, brightness):
+    return tuple(c * (brightness + 1) >> 8 for c in colour)  # scale8_video-ish, as show()
+
+
+def bar_colour(frame):
+    if frame.us > frame.budget_us():
+        return (255, 40, 40)
+    return (255, 176, 0) if frame.us * 4 > frame.budget_us() * 3 else (40, 200, 40)
+
+
+def render_image(frame, pixel):
+    """Rows of rgb tuples, the leds then the time bar and its number"""
+    width = max(8 * 4, max(len(row) for row in frame.rows) * pixel)
+    image = []
+    for row in frame.rows:
+        line = []
+        for colour in row:
+            line += [scale(colour, frame.brightness)] * pixel
+        line += [(0, 0, 0)] * (width - len(line))
+        image += [list(line) for _ in range(pixel)] + [[(0, 0, 0)] * width for _ in range(GAP)]
+
+    filled = min(width, width * frame.us // frame.budget_us())
+    colour = bar_colour(frame)
+    image += [[colour] * filled + [(48, 48, 48)] * (width - filled) for _ in range(2)]
+
+    text = [[(0, 0, 0)] * width for _ in range(BAR_HEIGHT - 2)]
+    for n, digit in enumerate(str(frame.us)):
+        for y in range(5):
+            for x in range(3):
+                if DIGITS[int(digit)][y * 3 + x] == "1" and 4 * n + x < width:
+                    text[y][4 * n + x] = (255, 255, 255)
+    return image + text
+
+
+def write_ppm(path, image):
+    with open(path, "wb") as f:
+        f.write(b"P6 %d %d 255\n" % (len(image[0]), len(image)))
+        f.write(bytes(c for row in image for pixel in row for c in pixel))
+
+
+def write_png(path, image):
+    def chunk(kind, data):
+        return struct.pack(">I", len(data)) + kind + data + struct.pack(">I", zlib.crc32(kind + data) & 0xFFFFFFFF)
+
+    raw = b"".join(b"\x00" + bytes(c for pixel in row for c in pixel) for row in image)
+    with open(path, "wb") as f:
+        f.write(b"\x89PNG\r\n\x1a\n")
+        f.write(chunk(b"IHDR", struct.pack(">IIBBBBB", len(image[0]), len(image), 8, 2, 0, 0, 0)))
+        f.write(chunk(b"IDAT", zlib.compress(raw)))
+        f.write(chunk(b"IEND", b""))
+
+
+def show_terminal(frame):
+    out = ["\x1b[H"]
+    for row in frame.rows:
+        for colour in row:
+            out.append("\x1b[48;2;%d;%d;%dm  " % scale(colour, frame.brightness))
+        out.append("\x1b[0m\x1b[K\n")
+    r, g, b = bar_colour(frame)
+    out.append("frame %5d  %9.3fs  \x1b[38;2;%d;%d;%dm%6d us\x1b[0m of %d us, %3d%%\x1b[K\n" % (
+        frame.number, frame.ms / 1000.0, r, g, b, frame.us, frame.budget_us(), 100 * frame.us // frame.budget_us()))
+    sys.stdout.write("".join(out))
+    sys.stdout.flush()
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__, formatter_class=argparse.RawDescriptionHelpFormatter)
+    parser.add_argument("port", nargs="?")
+    parser.add_argument("--file", help="render a dump kept with --capture instead of reading the sculpture")
+    parser.add_argument("--capture", help="also write the raw dump here")
+    parser.add_argument("--out", help="directory for the image sequence")
+    parser.add_argument("--png", action="store_true", help="png instead of ppm")
+    parser.add_argument("--pixel", type=int, default=8, help="size of a led in the images")
+    parser.add_argument("--term", action="store_true", help="live view in the terminal")
+    parser.add_argument("--frames", type=int, default=0, help="stop after this many, 0 runs until ctrl-c")
+    parser.add_argument("--baud", type=int, default=9600)
+    args = parser.parse_args()
+
+    if not args.file and not args.port:
+        parser.error("a port or --file is needed")
+    if args.out:
+        os.makedirs(args.out, exist_ok=True)
+        times = open(os.path.join(args.out, "frames.csv"), "w")
+        times.write("image,frame,ms,frame_us,budget_us\n")
+    capture = open(args.capture, "wb") if args.capture else None
+
+    port = None
+    if args.file:
+        chunks = iter([open(args.file, "rb").read()])
+    else:
+        import serial  # pyserial, only needed when talking to the sculpture
+
+        port = serial.Serial(args.port, args.baud, timeout=0.2)
+        time.sleep(2.5)  # opening the port resets the Mega
+        port.write(b"view on\n")
+        chunks = iter(lambda: port.read(512), None)
+
+    if args.term:
+        sys.stdout.write("\x1b[2J")
+    count, buf = 0, b""
+    try:
+        for data in chunks:
+            if capture:
+                capture.write(data)
+            frames, buf = parse_frames(buf + data)
+            for frame in frames:
+                if args.term:
+                    show_terminal(frame)
+                if args.out:
+                    name = "frame_%05d.%s" % (count, "png" if args.png else "ppm")
+                    (write_png if args.png else write_ppm)(os.path.join(args.out, name), render_image(frame, args.pixel))
+                    times.write("%s,%d,%d,%d,%d\n" % (name, frame.number, frame.ms, frame.us, frame.budget_us()))
+                if not args.term and not args.out:
+                    print("frame %d, %.3fs, %d us of %d" % (frame.number, frame.ms / 1000.0, frame.us, frame.budget_us()))
+                count += 1
+                if count == args.frames:
+                    raise KeyboardInterrupt
+    except KeyboardInterrupt:
+        pass
+    finally:
+        if port:
+            port.write(b"view off\n")
+        if args.out:
+            times.close()
+        if capture:
+            capture.close()
+    if not args.term:
+        print("%d frames" % count)
+
+
+if __name__ == "__main__":
+    main()
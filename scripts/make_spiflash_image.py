@@ -0,0 +1,69 @@
+#!/usr/bin/env python3
+"""
+Builds an image for the sculpture's optional SPI flash, see src/spiflash.h and src/dataset.h.
+
+    python3 scripts/make_spiflash_image.py spiflash.bin \\
+        --slot0 co2_week1.csv 0 1800 64 255 --slot1 co2_week2.csv 0 1800 64 255
+
+Each slot takes a csv of readings (one per line, last column used) plus the raw data
+range and the brightness range it maps to. Write the image to the chip with any SPI
+flash programmer (e.g. flashrom with a CH341A clip).
+"""
+
+import argparse
+import struct
+import sys
+
+from upload_dataset import read_values
+
+SLOT_SIZE = 0x10000
+MAGIC = 0xD6
+FORMAT_DZV = 1
+
+
+def dzv_encode(values):
+    out = bytearray()
+    prev = 0
+    for value in values:
+        delta = value - prev
+        prev = value
+        zigzag = (delta << 1) if delta >= 0 else ((-delta) << 1) - 1
+        while zigzag >= 0x80:
+            out.append((zigzag & 0x7F) | 0x80)
+            zigzag >>= 7
+        out.append(zigzag)
+    return bytes(out)
+
+
+def build_slot(path, in_min, in_max, out_min, out_max):
+    values = read_values(path)
+    if not values:
+        sys.exit("no readings in %s" % path)
+    data = dzv_encode(values)
+    # DatasetHeader: format, count, size, inMin, inMax, outMin, outMax, magic
+    header = struct.pack("<BHHhhhhB", FORMAT_DZV, len(values), len(data), in_min, in_max, out_min, out_max, MAGIC)
+    if len(header) + len(data) > SLOT_SIZE or len(data) > 0xFFFF:
+        sys.exit("%s does not fit in a %d byte slot" % (path, SLOT_SIZE))
+    print("%s: %d readings, %d bytes" % (path, len(values), len(data)))
+    return header + data
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__, formatter_class=argparse.RawDescriptionHelpFormatter)
+    parser.add_argument("image")
+    for slot in (0, 1):
+        parser.add_argument("--slot%d" % slot, nargs=5, metavar=("CSV", "IN_MIN", "IN_MAX", "OUT_MIN", "OUT_MAX"))
+    args = parser.parse_args()
+
+    image = bytearray(b"\xff" * 2 * SLOT_SIZE)  # erased flash reads 0xFF, so empty slots stay invalid
+    for slot, spec in enumerate((args.slot0, args.slot1)):
+        if spec:
+            data = build_slot(spec[0], *[int(x) for x in spec[1:]])
+            image[slot * SLOT_SIZE:slot * SLOT_SIZE + len(data)] = data
+
+    with open(args.image, "wb") as f:
+        f.write(image)
+
+
+if __name__ == "__main__":
+    main()
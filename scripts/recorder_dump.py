@@ -0,0 +1,109 @@
+#!/usr/bin/env python3
+"""
+Reads the black box log saved on a sculpture with "rec save" and prints it as a
+timeline, see src/recorder.h.
+
+    python3 scripts/recorder_dump.py /dev/ttyACM0              print the saved log
+    python3 scripts/recorder_dump.py /dev/ttyACM0 --raw f.bin  and keep it
+    python3 scripts/recorder_dump.py --file f.bin              print a kept log
+
+Times are seconds from the first event in the log. Needs pyserial.
+"""
+
+import argparse
+import os
+import struct
+import sys
+import time
+
+sys.path.insert(0, os.path.dirname(os.path.abspath(__file__)))
+from upload_dataset import Link  # noqa: E402
+
+MAGIC = 0xB7
+HEADER_SIZE = 3
+RING_SIZE = 512
+BUTTON, RANGE, MODE = 1, 2, 3
+NO_RANGE = 255
+IDLE_MODE, BUTTON_MODE = 1, 2
+
+
+def read_log(link):
+    data = b""
+    size = HEADER_SIZE
+    while len(data) < size:
+        for _ in range(5):
+            status, chunk = link.request("R", struct.pack("<H", len(data)))
+            if status == "K" and chunk:
+                break
+        else:
+            sys.exit("reading at %d failed: %s" % (len(data), status))
+        data += chunk
+        if len(data) >= HEADER_SIZE and size == HEADER_SIZE:
+            if data[0] != MAGIC:
+                sys.exit("no saved log, send \"rec save\" first")
+            size = HEADER_SIZE + min(struct.unpack_from("<H", data, 1)[0], RING_SIZE)
+    return data[:size]
+
+
+def events(log):
+    if len(log) < HEADER_SIZE or log[0] != MAGIC:
+        sys.exit("not a saved log")
+    body = log[HEADER_SIZE:HEADER_SIZE + struct.unpack_from("<H", log, 1)[0]]
+    pos, ms = 0, None
+    while pos < len(body):
+        kind, arg = body[pos] >> 4, body[pos] & 0x0F
+        pos += 1
+        dt, shift = 0, 0
+        while True:
+            c = body[pos]
+            pos += 1
+            dt |= (c & 0x7F) << shift
+            shift += 7
+            if not c & 0x80:
+                break
+        reading = None
+        if kind == RANGE:
+            reading = body[pos]
+            pos += 1
+        ms = 0 if ms is None else ms + dt  # the first interval is to an event no longer in the log
+        yield ms, kind, arg, reading
+
+
+def describe(kind, arg, reading):
+    if kind == BUTTON:
+        return "button%d pressed" % arg
+    if kind == RANGE:
+        return "no reading" if reading == NO_RANGE else "distance %d mm" % (reading * 8)
+    if kind == MODE:
+        return "strip%d %s" % ((arg >> 2) + 1, "BUTTON MODE" if arg & 3 == BUTTON_MODE else "IDLE MODE")
+    return "unknown event %d" % kind
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__, formatter_class=argparse.RawDescriptionHelpFormatter)
+    parser.add_argument("port", nargs="?")
+    parser.add_argument("--file", help="print a log kept with --raw instead of reading the sculpture")
+    parser.add_argument("--raw", help="also write the log here")
+    parser.add_argument("--baud", type=int, default=9600)
+    args = parser.parse_args()
+
+    if args.file:
+        with open(args.file, "rb") as f:
+            log = f.read()
+    elif args.port:
+        link = Link(args.port, args.baud)
+        time.sleep(2.5)  # opening the port resets the Mega
+        log = read_log(link)
+    else:
+        parser.error("a port or --file is needed")
+
+    if args.raw:
+        with open(args.raw, "wb") as f:
+            f.write(log)
+
+    for ms, kind, arg, reading in events(log):
+        print("%9.3f  %s" % (ms / 1000.0, describe(kind, arg, reading)))
+
+
+if __name__ == "__main__":
+    main()
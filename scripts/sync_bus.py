@@ -0,0 +1,174 @@
+#!/usr/bin/env python3
+"""
+Stands in for the sculptures' sync bus (src/sync.h) on Linux, with pseudo terminals
+joined like an RS-485 bus: whatever one endpoint sends, all the others receive.
+
+    python3 scripts/sync_bus.py --endpoints 3            print pty paths to attach to
+    python3 scripts/sync_bus.py --port /dev/ttyUSB0      join a real sculpture's bus
+    python3 scripts/sync_bus.py --simulate 3 --sniff     three simulated sculptures
+
+Simulated sculptures run the same clock lock as sync.h, each with its own crystal
+error, and print how far each is from the master once a second. Sculpture 1 is the
+master, as SYNC_MASTER_ID. The ptys have no transmission delay, so the others settle
+SYNC_LATENCY_MS ahead of it. --sniff prints every frame on the bus. --port needs pyserial.
+"""
+
+import argparse
+import os
+import random
+import select
+import struct
+import time
+import tty
+
+SOF = 0x5A
+BEACON_MS = 1000
+LATENCY_MS = 13
+STEP_MS = 250
+MAX_PPM = 5000
+FRAME_LEN = {ord("S"): 8, ord("B"): 5}
+
+
+def crc8(data):
+    crc = 0
+    for b in data:
+        crc ^= b
+        for _ in range(8):
+            crc = ((crc << 1) ^ 0x07) & 0xFF if crc & 0x80 else (crc << 1) & 0xFF
+    return crc
+
+
+class Parser:
+    """Byte at a time, as sync_parse_byte()"""
+
+    def __init__(self):
+        self.frame = b""
+
+    def feed(self, data):
+        frames = []
+        for c in data:
+            if not self.frame and c != SOF:
+                continue
+            if len(self.frame) == 1 and c not in FRAME_LEN:
+                self.frame = bytes([c]) if c == SOF else b""
+                continue
+            self.frame += bytes([c])
+            if len(self.frame) > 1 and len(self.frame) == FRAME_LEN[self.frame[1]]:
+                if crc8(self.frame[1:-1]) == self.frame[-1]:
+                    frames.append(self.frame)
+                self.frame = b""
+        return frames
+
+
+class Node:
+    """A simulated sculpture, its millis() running fast or slow by ppm"""
+
+    def __init__(self, node_id, fd, ppm):
+        self.id, self.fd, self.ppm = node_id, fd, ppm
+        self.start = time.monotonic()
+        self.parser = Parser()
+        self.locked = False
+        self.base_local = self.base_master = 0
+        self.rate_ppm = 0
+        self.free_offset = random.randint(0, 60000)  # booted at different times
+        self.next_beacon = BEACON_MS
+
+    def millis(self):
+        return int((time.monotonic() - self.start) * 1000 * (1 + self.ppm / 1e6))
+
+    def sync_millis(self):
+        if not self.locked:
+            return self.millis() + self.free_offset
+        elapsed = self.millis() - self.base_local
+        return int(self.base_master + elapsed + elapsed * self.rate_ppm / 1e6)
+
+    def on_beacon(self, master):
+        now, predicted = self.millis(), self.sync_millis()
+        master += LATENCY_MS
+        error = master - predicted
+        if not self.locked or abs(error) > STEP_MS:
+            self.base_master = master
+        else:
+            self.rate_ppm = max(-MAX_PPM, min(MAX_PPM, self.rate_ppm + error * 1000000 // BEACON_MS // 32))
+            self.base_master = predicted + int(error / 2)
+        self.base_local = now
+        self.locked = True
+
+    def service(self):
+        try:
+            data = os.read(self.fd, 256)
+        except BlockingIOError:
+            data = b""
+        for frame in self.parser.feed(data):
+            if frame[2] != self.id and frame[1] == ord("S") and self.id != 1:
+                self.on_beacon(struct.unpack("<I", frame[3:7])[0])
+        if self.id == 1 and self.millis() >= self.next_beacon:
+            self.next_beacon += BEACON_MS
+            body = bytes([ord("S"), self.id]) + struct.pack("<I", self.sync_millis() & 0xFFFFFFFF)
+            os.write(self.fd, bytes([SOF]) + body + bytes([crc8(body)]))
+
+
+def open_pty():
+    master, slave = os.openpty()
+    tty.setraw(slave)
+    os.set_blocking(master, False)
+    return master, slave
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__, formatter_class=argparse.RawDescriptionHelpFormatter)
+    parser.add_argument("--endpoints", type=int, default=0, help="ptys to make for other programs")
+    parser.add_argument("--port", action="append", default=[], help="real serial port on the bus")
+    parser.add_argument("--simulate", type=int, default=0, help="simulated sculptures, 1 is the master")
+    parser.add_argument("--sniff", action="store_true")
+    parser.add_argument("--baud", type=int, default=9600)
+    args = parser.parse_args()
+
+    endpoints = []  # (fd to read what it sends and write what it hears, name)
+    for _ in range(args.endpoints):
+        master, slave = open_pty()
+        endpoints.append((master, os.ttyname(slave)))
+        print("endpoint %s" % os.ttyname(slave))
+    ports = []
+    for name in args.port:
+        import serial  # pyserial, only needed for real ports
+
+        ports.append(serial.Serial(name, args.baud, timeout=0))
+    nodes = []
+    for i in range(args.simulate):
+        master, slave = open_pty()
+        os.set_blocking(slave, False)
+        endpoints.append((master, "sculpture %d" % (i + 1)))
+        nodes.append(Node(i + 1, slave, random.uniform(-500, 500)))
+
+    sniffer = Parser()
+    last_report = time.monotonic()
+    while True:
+        fds = [fd for fd, _ in endpoints] + [p.fileno() for p in ports]
+        readable, _, _ = select.select(fds, [], [], 0.005)
+        for fd in readable:
+            port = next((p for p in ports if p.fileno() == fd), None)
+            data = port.read(256) if port else os.read(fd, 256)
+            for other, _ in endpoints:
+                if other != fd:
+                    os.write(other, data)
+            for p in ports:
+                if p.fileno() != fd:
+                    p.write(data)
+            if args.sniff:
+                for frame in sniffer.feed(data):
+                    kind = "beacon %d" % struct.unpack("<I", frame[3:7])[0] if frame[1] == ord("S") else "button %d" % frame[3]
+                    print("%.3f node %d %s" % (time.monotonic(), frame[2], kind))
+        for node in nodes:
+            node.service()
+        if nodes and time.monotonic() - last_report >= 1:
+            last_report = time.monotonic()
+            reference = nodes[0].sync_millis()
+            print("  ".join("%d: %+5d ms %+5d ppm%s" % (n.id, n.sync_millis() - reference, n.rate_ppm, "" if n.locked or n.id == 1 else " free") for n in nodes))
+
+
+if __name__ == "__main__":
+    try:
+        main()
+    except KeyboardInterrupt:
+        pass
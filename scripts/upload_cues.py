@@ -0,0 +1,110 @@
+#!/usr/bin/env python3
+"""
+Writes a show schedule to the sculpture's EEPROM and sets its clock, see src/scheduler.h.
+
+    python3 scripts/upload_cues.py /dev/ttyACM0 schedules/gallery.cues
+    python3 scripts/upload_cues.py /dev/ttyACM0 --time                  set the clock only
+    python3 scripts/upload_cues.py /dev/ttyACM0 --time 10:55 --speed 60 virtual clock
+    python3 scripts/upload_cues.py /dev/ttyACM0 --erase
+
+The schedule has one cue per line: time (24 hour), show mode (normal, attract or
+night), brightness cap 0 - 255 and optionally frames per second. '#' starts a comment.
+--time without a value sends the laptop's time. --speed runs the clock that many times
+faster, so 60 plays an hour of cues in a minute. Needs pyserial.
+"""
+
+import argparse
+import datetime
+import os
+import re
+import struct
+import sys
+import time
+
+sys.path.insert(0, os.path.dirname(os.path.abspath(__file__)))
+from upload_dataset import Link  # noqa: E402
+
+MODES = {"normal": 0, "attract": 1, "night": 2}
+MAX_LEN = 253  # EEPROM_CUES_SIZE - sizeof(CueTableHeader)
+CHUNK = 32
+
+
+def parse_time(text):
+    m = re.match(r"^(\d{1,2}):(\d{2})(?::(\d{2}))?$", text)
+    if not m or int(m.group(1)) > 23 or int(m.group(2)) > 59:
+        raise ValueError("not a time of day: %r" % text)
+    return int(m.group(1)) * 3600 + int(m.group(2)) * 60 + int(m.group(3) or 0)
+
+
+def parse_cues(path):
+    cues = []
+    with open(path) as f:
+        for lineno, line in enumerate(f, 1):
+            words = line.split("#")[0].split()
+            if not words:
+                continue
+            where = "%s:%d" % (path, lineno)
+            if len(words) not in (3, 4):
+                raise ValueError("%s: expected time, mode, brightness and optionally fps" % where)
+            minute = parse_time(words[0]) // 60
+            if words[1].lower() not in MODES:
+                raise ValueError("%s: unknown mode %r" % (where, words[1]))
+            brightness = int(words[2])
+            fps = int(words[3]) if len(words) == 4 else 0
+            if not 0 <= brightness <= 255 or not 0 <= fps <= 200:
+                raise ValueError("%s: brightness 0 - 255, fps 1 - 200 or 0 for the default" % where)
+            cues.append((minute, MODES[words[1].lower()], brightness, fps))
+    cues.sort()  # the sculpture relies on them being in time order
+    if len({c[0] for c in cues}) != len(cues):
+        raise ValueError("%s: two cues at the same time" % path)
+    return b"".join(struct.pack("<HBBB", *c) for c in cues)
+
+
+def send_or_exit(link, ftype, payload, what):
+    for _ in range(5):
+        status = link.send(ftype, payload)
+        if status == "K":
+            return
+    sys.exit("%s failed: %s" % (what, status))
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__, formatter_class=argparse.RawDescriptionHelpFormatter)
+    parser.add_argument("port")
+    parser.add_argument("schedule", nargs="?")
+    parser.add_argument("--time", nargs="?", const="now", help="HH:MM[:SS], the laptop's time if left out")
+    parser.add_argument("--speed", type=int, default=1, choices=range(1, 256), metavar="1-255")
+    parser.add_argument("--erase", action="store_true", help="remove the schedule")
+    parser.add_argument("--baud", type=int, default=9600)
+    args = parser.parse_args()
+
+    try:
+        table = parse_cues(args.schedule) if args.schedule else None
+        if args.time and args.time != "now":
+            seconds = parse_time(args.time)
+    except ValueError as e:
+        sys.exit(str(e))
+    if table is not None and len(table) > MAX_LEN:
+        sys.exit("too many cues, the most is %d" % (MAX_LEN // 5))
+
+    link = Link(args.port, args.baud)
+    time.sleep(2.5)  # opening the port resets the Mega
+
+    if table is not None or args.erase:
+        send_or_exit(link, "W", struct.pack("<H", 0), "erase")
+    if table:
+        for offset in range(0, len(table), CHUNK):
+            send_or_exit(link, "U", struct.pack("<H", offset) + table[offset:offset + CHUNK], "cue frame at %d" % offset)
+        send_or_exit(link, "W", struct.pack("<H", len(table)), "end")
+        print("%d cues written" % (len(table) // 5))
+
+    if args.time or table:
+        if not args.time or args.time == "now":
+            now = datetime.datetime.now()
+            seconds = now.hour * 3600 + now.minute * 60 + now.second
+        send_or_exit(link, "T", struct.pack("<IB", seconds, args.speed), "time")
+        print("clock set to %02d:%02d:%02d, x%d" % (seconds // 3600, seconds // 60 % 60, seconds % 60, args.speed))
+
+
+if __name__ == "__main__":
+    main()
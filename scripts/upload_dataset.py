@@ -0,0 +1,121 @@
+#!/usr/bin/env python3
+"""
+Uploads a data set to one of the sculpture's EEPROM slots over serial, see src/upload.h.
+
+    python3 scripts/upload_dataset.py /dev/ttyACM0 0 readings.csv --in-range 0 1800 --out-range 64 255
+
+The csv holds one reading per line (the last column is used if there are several).
+Slot 0 is played by button 0, slot 1 by button 1. Needs pyserial.
+"""
+
+import argparse
+import struct
+import sys
+import time
+
+SOF = 0xA5
+MAX_VALUES = 16
+
+
+def crc8(data):
+    crc = 0
+    for b in data:
+        crc ^= b
+        for _ in range(8):
+            crc = ((crc << 1) ^ 0x07) & 0xFF if crc & 0x80 else (crc << 1) & 0xFF
+    return crc
+
+
+def read_values(path):
+    values = []
+    with open(path) as f:
+        for line in f:
+            line = line.strip()
+            if not line or line.startswith("#"):
+                continue
+            field = line.split(",")[-1].strip()
+            try:
+                values.append(int(round(float(field))))
+            except ValueError:
+                continue  # header row
+    return values
+
+
+class Link:
+    def __init__(self, port, baud):
+        import serial  # pyserial, only needed when talking to the sculpture
+
+        self.port = serial.Serial(port, baud, timeout=0.1)
+        self.seq = 0
+
+    def send(self, ftype, payload, timeout=5.0):
+        return self.request(ftype, payload, timeout)[0]
+
+    def request(self, ftype, payload, timeout=5.0):
+        """Sends a frame, returns the reply's status and the data after it"""
+        self.seq = (self.seq + 1) & 0xFF
+        body = bytes([ord(ftype), self.seq, len(payload)]) + payload
+        self.port.write(bytes([SOF]) + body + bytes([crc8(body)]))
+        return self.wait_reply(ord(ftype), timeout)
+
+    def wait_reply(self, ftype, timeout):
+        # the sculpture prints debug text on the same port, so scan for the reply frame
+        deadline = time.time() + timeout
+        buf = b""
+        while time.time() < deadline:
+            buf += self.port.read(64)
+            i = buf.find(bytes([SOF]))
+            while i >= 0 and len(buf) - i >= 6:
+                length = buf[i + 3]
+                frame = buf[i + 1:i + 5 + length]
+                complete = len(frame) == 4 + length  # if not, looked at again after the next read
+                if complete and frame[0] == ftype and frame[1] == self.seq and length >= 1 and crc8(frame[:-1]) == frame[-1]:
+                    return chr(frame[3]), frame[4:-1]
+                i = buf.find(bytes([SOF]), i + 1)
+        return None, b""
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__, formatter_class=argparse.RawDescriptionHelpFormatter)
+    parser.add_argument("port")
+    parser.add_argument("slot", type=int, choices=[0, 1])
+    parser.add_argument("csv")
+    parser.add_argument("--in-range", type=int, nargs=2, required=True, metavar=("MIN", "MAX"))
+    parser.add_argument("--out-range", type=int, nargs=2, default=[64, 255], metavar=("MIN", "MAX"))
+    parser.add_argument("--baud", type=int, default=9600)
+    args = parser.parse_args()
+
+    values = read_values(args.csv)
+    if not values:
+        sys.exit("no readings in %s" % args.csv)
+
+    link = Link(args.port, args.baud)
+    time.sleep(2.5)  # opening the port resets the Mega
+
+    begin = struct.pack("<Bhhhhh", args.slot, len(values), args.in_range[0], args.in_range[1], *args.out_range)
+    status = link.send("B", begin)
+    if status != "K":
+        sys.exit("begin refused: %s" % status)
+
+    index = 0
+    while index < len(values):
+        chunk = values[index:index + MAX_VALUES]
+        payload = struct.pack("<H%dh" % len(chunk), index, *chunk)
+        for _ in range(5):
+            status = link.send("D", payload)
+            if status == "K":
+                break
+        else:
+            sys.exit("data frame at %d failed: %s" % (index, status))
+        index += len(chunk)
+        print("\r%d/%d" % (index, len(values)), end="", flush=True)
+    print()
+
+    status = link.send("E", b"")
+    if status != "K":
+        sys.exit("end refused: %s" % status)
+    print("uploaded %d readings to slot %d" % (len(values), args.slot))
+
+
+if __name__ == "__main__":
+    main()
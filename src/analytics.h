@@ -0,0 +1,197 @@
+/*--------------------------------------------------------------------------------
+  Visitor analytics. Counted per hour of the day, for the last 24 hours
+    visits       : someone came within presenceRange of the dist sensor
+    presses      : per button, local presses only
+    completed    : playbacks that ran to the end with the visitor still there
+    abandoned    : playbacks whose visitor left before the end
+  and a histogram of how long visits lasted, since the counters were last cleared.
+
+  A visit ends when nobody has been seen for ANALYTICS_GAP_MS, so a visitor stepping
+  in and out of range is one visit. Every event is a counter increment, the hour
+  rolling over clears one bucket. Hours are the show schedule's clock when it is set,
+  otherwise hours since power up.
+
+  The counters are written to EEPROM_ANALYTICS_ADDR every ANALYTICS_FLUSH_HOURS, and
+  when they are cleared or dumped, a byte per loop(), as magic (cleared first),
+  counters, crc8 and the magic again, and read back at boot. The magic byte is
+  written twice a flush, 12 times a day, ~20 years of its 100k cycles; a power cut
+  loses at most the hours since the last flush. The counters keep changing during
+  the write, so the crc is over the bytes as they were written. scripts/analytics_dump.py reads them over serial with 'A' frames
+  (see upload.h).
+--------------------------------------------------------------------------------*/
+
+const uint8_t ANALYTICS_MAGIC = 0xA9;
+const uint8_t ANALYTICS_HOURS = 24;
+const uint8_t ANALYTICS_DWELL_BUCKETS = 8;
+const uint16_t ANALYTICS_DWELL_EDGES[ANALYTICS_DWELL_BUCKETS - 1] = {5, 15, 30, 60, 120, 300, 600}; //seconds
+const unsigned int ANALYTICS_GAP_MS = 3000;
+const uint8_t ANALYTICS_CLOCK_SET = 0x01; //flags, hours are times of day
+const uint8_t ANALYTICS_FLUSH_HOURS = 4;
+
+struct HourStats
+{
+    uint16_t visits;
+    uint16_t presses[2];
+    uint8_t completed, abandoned; //saturate at 255
+};
+
+struct AnalyticsStats
+{
+    uint8_t hour;  //bucket being counted into
+    uint8_t flags;
+    HourStats hours[ANALYTICS_HOURS];
+    uint16_t dwell[ANALYTICS_DWELL_BUCKETS];
+};
+
+const uint16_t ANALYTICS_FLUSH_STEPS = 1 + sizeof(AnalyticsStats) + 2; //magic cleared, counters, crc, magic
+
+AnalyticsStats analytics;
+bool isVisitActive = false;
+uint32_t visitStartms, visitLastSeenms;
+bool isPlaybackWatched[2];          //per strip, the visitor is still there
+
+uint16_t analyticsFlushStep = ANALYTICS_FLUSH_STEPS; //ANALYTICS_FLUSH_STEPS when not flushing
+uint8_t analyticsFlushCrc;
+uint8_t analyticsUnflushedHours = 0;
+
+void analytics_clear()
+{
+    memset(&analytics, 0, sizeof(analytics));
+}
+
+/*--------------------------------------------------------------------------------
+  Done once during setup(), carries on from the last flush
+--------------------------------------------------------------------------------*/
+void analytics_begin()
+{
+    const int addr = EEPROM_ANALYTICS_ADDR;
+    uint8_t crc = 0;
+
+    for (uint16_t i = 0; i < sizeof(analytics); i++)
+    {
+        ((uint8_t *)&analytics)[i] = EEPROM.read(addr + 1 + i);
+        crc = crc8_update(crc, ((uint8_t *)&analytics)[i]);
+    }
+
+    if (EEPROM.read(addr) != ANALYTICS_MAGIC || EEPROM.read(addr + 1 + sizeof(analytics)) != crc || analytics.hour >= ANALYTICS_HOURS)
+    {
+        analytics_clear();
+    }
+}
+
+void analytics_flush()
+{
+    analyticsFlushStep = 0;
+    analyticsFlushCrc = 0;
+    analyticsUnflushedHours = 0;
+}
+
+/*--------------------------------------------------------------------------------
+  One EEPROM byte of a flush, magic cleared, then the counters, crc and magic
+--------------------------------------------------------------------------------*/
+void analytics_flush_step()
+{
+    const int addr = EEPROM_ANALYTICS_ADDR;
+
+    if (analyticsFlushStep == 0)
+    {
+        EEPROM.update(addr, 0xFF);
+    }
+    else if (analyticsFlushStep <= sizeof(analytics))
+    {
+        uint8_t c = ((uint8_t *)&analytics)[analyticsFlushStep - 1];
+        EEPROM.update(addr + analyticsFlushStep, c);
+        analyticsFlushCrc = crc8_update(analyticsFlushCrc, c);
+    }
+    else if (analyticsFlushStep == sizeof(analytics) + 1)
+    {
+        EEPROM.update(addr + analyticsFlushStep, analyticsFlushCrc);
+    }
+    else
+    {
+        EEPROM.update(addr, ANALYTICS_MAGIC);
+    }
+    analyticsFlushStep++;
+}
+
+HourStats &analytics_now()
+{
+    return analytics.hours[analytics.hour];
+}
+
+void analytics_on_press(uint8_t button)
+{
+    analytics_now().presses[button]++;
+}
+
+void analytics_on_playback_start(uint8_t strip)
+{
+    isPlaybackWatched[strip] = true;
+}
+
+void analytics_on_playback_end(uint8_t strip)
+{
+    HourStats &now = analytics_now();
+    uint8_t &count = isPlaybackWatched[strip] ? now.completed : now.abandoned;
+    count = qadd8(count, 1);
+}
+
+void analytics_on_visit_end()
+{
+    uint32_t seconds = (visitLastSeenms - visitStartms) / 1000;
+    uint8_t bucket = 0;
+
+    while (bucket < ANALYTICS_DWELL_BUCKETS - 1 && seconds >= ANALYTICS_DWELL_EDGES[bucket])
+    {
+        bucket++;
+    }
+    if (analytics.dwell[bucket] < 0xFFFF)
+    {
+        analytics.dwell[bucket]++;
+    }
+
+    isVisitActive = false;
+    isPlaybackWatched[0] = isPlaybackWatched[1] = false;
+}
+
+/*--------------------------------------------------------------------------------
+  Called once per loop() with the hour of the day (or of uptime)
+--------------------------------------------------------------------------------*/
+void analytics_service(uint8_t hour, bool isTimeOfDay)
+{
+    hour %= ANALYTICS_HOURS;
+    if (hour != analytics.hour)
+    {
+        for (uint8_t i = 0; i < ANALYTICS_HOURS && analytics.hour != hour; i++) //more than one if the clock was set or the power was off
+        {
+            analytics.hour = (analytics.hour + 1) % ANALYTICS_HOURS;
+            memset(&analytics_now(), 0, sizeof(HourStats));
+            analyticsUnflushedHours++;
+        }
+        if (analyticsUnflushedHours >= ANALYTICS_FLUSH_HOURS)
+        {
+            analytics_flush();
+        }
+    }
+    analytics.flags = isTimeOfDay ? ANALYTICS_CLOCK_SET : 0;
+
+    if (isUserPresent)
+    {
+        if (!isVisitActive)
+        {
+            isVisitActive = true;
+            visitStartms = millis();
+            analytics_now().visits++;
+        }
+        visitLastSeenms = millis();
+    }
+    else if (isVisitActive && millis() - visitLastSeenms > ANALYTICS_GAP_MS)
+    {
+        analytics_on_visit_end();
+    }
+
+    if (analyticsFlushStep < ANALYTICS_FLUSH_STEPS)
+    {
+        analytics_flush_step();
+    }
+}
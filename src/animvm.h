@@ -0,0 +1,246 @@
+/*--------------------------------------------------------------------------------
+  Animation programs (playbackStyle PLAYBACK_PROGRAM). Instead of the built in fill or
+  wave, each strip runs a small bytecode program over its data set, so a new playback
+  animation is a text file assembled by scripts/anim_asm.py rather than a change to
+  strip1_playback_readings() and its twin.
+
+  Programs come from the animation program uploaded to EEPROM over serial (see
+  upload.h) if there is a valid one, otherwise from the built in programs assembled
+  from programs/ at build time (see programs_generated.h), picked by playbackProgram.
+
+  Each strip has 8 byte registers r0 - r7 and a program counter. A program runs until
+  it waits, for at most VM_INSTRUCTIONS_PER_FRAME instructions, and FILL and FADE,
+  which touch every led of the strip, for at most VM_PIXELS_PER_FRAME leds between
+  them. An op that would go over carries on next frame, so a program can never
+  overrun the frame however it is written. END, a bad opcode or running off the end
+  finishes playback.
+
+  Opcodes, one byte each, then their operands (r: register, n: byte, a: address)
+    END              finish playback, the strip fades out and goes idle
+    SET r n          r = n
+    ADD r n          r = r + n, n signed, saturating at 0 and 255
+    FILL r           whole strip in the palette colour of level r, dimmed to r
+    FADE n           fade the strip towards black by n/256
+    WAIT n           stop for n frames, WAIT 0 is the same as WAIT 1
+    LOOP r a         r = r - 1, jump to a unless r is 0
+    READ r a         r = next reading of the data set, jump to a if there are no more
+    HOLD a           jump to a unless the next reading is due on the playback clock
+    BLEND n n        blend mode and opacity for FILL and SPARKLE (see blend.h)
+    SPARKLE r        one white pixel at a random place, with a chance of r/256
+    JMP a            jump to a
+--------------------------------------------------------------------------------*/
+
+const uint8_t OP_END = 0, OP_SET = 1, OP_ADD = 2, OP_FILL = 3, OP_FADE = 4, OP_WAIT = 5, OP_LOOP = 6,
+              OP_READ = 7, OP_HOLD = 8, OP_BLEND = 9, OP_SPARKLE = 10, OP_JMP = 11;
+
+const uint8_t VM_REGISTERS = 8;
+const uint8_t VM_INSTRUCTIONS_PER_FRAME = 24;
+const int VM_PIXELS_PER_FRAME = 160; //a FILL and a FADE of the longest strip (75 leds)
+const uint8_t PROGRAM_MAGIC = 0xA7;
+
+struct ProgramHeader //at EEPROM_PROGRAM_ADDR, followed by the code
+{
+    uint16_t len;
+    uint8_t magic; //written last
+};
+
+const int PROGRAM_MAX_LEN = EEPROM_PROGRAM_SIZE - sizeof(ProgramHeader); //under 256, addresses are one byte
+
+struct AnimVm
+{
+    uint8_t source;             //SRC_FLASH or SRC_EEPROM
+    const uint8_t *flash;       //SRC_FLASH: start of the code
+    uint16_t len;
+    uint8_t pc;
+    uint8_t r[VM_REGISTERS];
+    uint8_t wait;               //frames left to wait
+    uint8_t mode, opacity;      //set by BLEND
+    bool isDue;                 //a reading has come due on the playback clock since the last READ
+};
+
+AnimVm strip1vm, strip2vm;
+
+bool program_eeprom_valid(ProgramHeader &header)
+{
+    EEPROM.get(EEPROM_PROGRAM_ADDR, header);
+
+    return header.magic == PROGRAM_MAGIC && header.len > 0 && header.len <= PROGRAM_MAX_LEN;
+}
+
+/*--------------------------------------------------------------------------------
+  Loads the program and clears the registers, when playback of a data set starts
+--------------------------------------------------------------------------------*/
+void vm_start(AnimVm &vm)
+{
+    ProgramHeader header;
+
+    if (program_eeprom_valid(header))
+    {
+        vm.source = SRC_EEPROM;
+        vm.len = header.len;
+    }
+    else
+    {
+        AnimProgram builtin;
+        memcpy_P(&builtin, &ANIM_PROGRAMS[playbackProgram % NUM_ANIM_PROGRAMS], sizeof(AnimProgram));
+
+        vm.source = SRC_FLASH;
+        vm.flash = builtin.code;
+        vm.len = builtin.len;
+    }
+
+    vm.pc = 0;
+    vm.wait = 0;
+    vm.mode = BLEND_REPLACE;
+    vm.opacity = 255;
+    vm.isDue = false;
+    memset(vm.r, 0, sizeof(vm.r));
+}
+
+uint8_t vm_fetch(AnimVm &vm)
+{
+    if (vm.pc >= vm.len)
+    {
+        vm.pc = 0xFF; //past the end, reads END from here on
+        return OP_END;
+    }
+    if (vm.source == SRC_EEPROM)
+    {
+        return EEPROM.read(EEPROM_PROGRAM_ADDR + sizeof(ProgramHeader) + vm.pc++);
+    }
+    return pgm_read_byte(vm.flash + vm.pc++);
+}
+
+uint8_t &vm_register(AnimVm &vm)
+{
+    return vm.r[vm_fetch(vm) & (VM_REGISTERS - 1)];
+}
+
+/*--------------------------------------------------------------------------------
+  Runs a strip's program for one frame. isNextReading is the playback clock of the
+  strip, ticked once per frame by the caller. Returns false once the program has ended.
+--------------------------------------------------------------------------------*/
+bool vm_run(AnimVm &vm, CRGB *leds, int numLeds, DataCursor &cursor, bool isNextReading)
+{
+    vm.isDue |= isNextReading;
+
+    if (vm.wait > 0)
+    {
+        vm.wait--;
+        return true;
+    }
+
+    uint8_t mode = layerMode, opacity = layerOpacity;
+    bool isRunning = true, isWaiting = false;
+    int pixels = 0; //leds touched by FILL and FADE this frame
+
+    layerMode = vm.mode;
+    layerOpacity = scale8(opacity, vm.opacity); //fade with the layer as well
+
+    for (uint8_t n = 0; n < VM_INSTRUCTIONS_PER_FRAME && isRunning && !isWaiting; n++)
+    {
+        uint8_t op = vm_fetch(vm);
+
+        if (op == OP_FILL || op == OP_FADE)
+        {
+            if (pixels > 0 && pixels + numLeds > VM_PIXELS_PER_FRAME)
+            {
+                vm.pc--; //run it first thing next frame
+                break;
+            }
+            pixels += numLeds;
+        }
+
+        switch (op) //dense, so a jump table
+        {
+        case OP_SET:
+        {
+            uint8_t &r = vm_register(vm);
+            r = vm_fetch(vm);
+            break;
+        }
+        case OP_ADD:
+        {
+            uint8_t &r = vm_register(vm);
+            int8_t delta = vm_fetch(vm);
+            r = (delta >= 0) ? qadd8(r, delta) : qsub8(r, -delta);
+            break;
+        }
+        case OP_FILL:
+        {
+            uint8_t level = vm_register(vm);
+            CRGB colour = palette_colour(level);
+            colour.nscale8_video(level);
+            blend_fill(leds, numLeds, colour);
+            break;
+        }
+        case OP_FADE:
+            fadeToBlackBy(leds, numLeds, vm_fetch(vm));
+            break;
+        case OP_WAIT:
+            vm.wait = vm_fetch(vm);
+            if (vm.wait > 0)
+            {
+                vm.wait--; //this frame is the first
+            }
+            isWaiting = true;
+            break;
+        case OP_LOOP:
+        {
+            uint8_t &r = vm_register(vm);
+            uint8_t target = vm_fetch(vm);
+            if (--r != 0)
+            {
+                vm.pc = target;
+            }
+            break;
+        }
+        case OP_READ:
+        {
+            uint8_t &r = vm_register(vm);
+            uint8_t target = vm_fetch(vm);
+            vm.isDue = false;
+            if (dataset_done(cursor))
+            {
+                vm.pc = target;
+            }
+            else
+            {
+                r = dataset_next(cursor);
+            }
+            break;
+        }
+        case OP_HOLD:
+        {
+            uint8_t target = vm_fetch(vm);
+            if (!vm.isDue)
+            {
+                vm.pc = target;
+            }
+            break;
+        }
+        case OP_BLEND:
+            vm.mode = vm_fetch(vm);
+            vm.opacity = vm_fetch(vm);
+            layerMode = vm.mode;
+            layerOpacity = scale8(opacity, vm.opacity);
+            break;
+        case OP_SPARKLE:
+            if (random8() < vm_register(vm))
+            {
+                blend_pixel(leds[random16(numLeds)], CRGB::White);
+            }
+            break;
+        case OP_JMP:
+            vm.pc = vm_fetch(vm);
+            break;
+        default: //OP_END or a bad opcode
+            isRunning = false;
+            break;
+        }
+    }
+
+    layerMode = mode;
+    layerOpacity = opacity;
+    return isRunning;
+}
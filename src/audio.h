@@ -0,0 +1,220 @@
+/*--------------------------------------------------------------------------------
+  Sound cues on a serial MP3 module (DFPlayer Mini or a clone), on a software serial
+  port: module RX to AUDIO_TX_PIN through a 1k resistor. The hardware serial ports are
+  all taken (Serial3's pins are the buttons).
+
+  Tracks on the SD card, one folder per sculpture ID (01 CO2, 02 PM25, 03 VOC)
+    001 idle, looped by the module while both strips are idle
+    002 strip 1 playback
+    003 strip 2 playback
+  A strip starting playback plays its track. A strip going idle goes back to the idle
+  track, unless the other strip is still playing. The volume follows the show mode.
+
+  Frames, 7E FF 06 cmd ack paramH paramL checksumH checksumL EF, checksum being minus
+  the sum of FF..paramL. Commands wait in a short queue. The one being sent is written
+  a byte per loop(), 10 loops a command, AUDIO_GAP_MS apart so the module takes them
+  all. A software serial write keeps interrupts off for ~1ms per byte at 9600 baud, so
+  while a command goes out the other streams take jitter: the hardware UARTs (live
+  sensor, sync bus, uploads on the debug port) can lose a byte that arrives back to
+  back with another, and millis() timed work runs up to ~1ms late. A byte per loop()
+  is the most they can take.
+
+  Nothing is read back. A reply takes ~10ms at 9600 baud and FastLED.show() keeps
+  interrupts off for 2.5 - 4ms of every frame, so the software serial receive would
+  lose a byte of almost every ack and track finished message. The commands are all
+  safe to send once without an ack (play and volume set a state, they do not step
+  it), and the idle track is looped by the module itself with the loop command.
+
+  scripts/fake_dfplayer.py stands in for the module.
+--------------------------------------------------------------------------------*/
+
+#include <SoftwareSerial.h>
+
+const uint8_t AUDIO_RX_PIN = 10, AUDIO_TX_PIN = 11; //RX unused, nothing is read back
+const uint8_t AUDIO_VOLUME[NUM_SHOW_MODES] = {20, 26, 0}; //0 - 30 for SHOW_NORMAL, SHOW_ATTRACT, SHOW_NIGHT
+
+const uint8_t AUDIO_CMD_PLAY_FOLDER = 0x0F, AUDIO_CMD_VOLUME = 0x06, AUDIO_CMD_LOOP = 0x19;
+const uint16_t AUDIO_LOOP_ON = 0, AUDIO_LOOP_OFF = 1; //for AUDIO_CMD_LOOP, the track playing
+const uint8_t AUDIO_TRACK_IDLE = 1, AUDIO_TRACK_STRIP1 = 2, AUDIO_TRACK_STRIP2 = 3;
+
+const uint8_t AUDIO_FRAME_LEN = 10;
+const uint8_t AUDIO_QUEUE_LEN = 4;
+const uint8_t AUDIO_BYTES_PER_FRAME = 1;  //max bytes written per loop(), each ~1ms with interrupts off
+const unsigned int AUDIO_GAP_MS = 100;    //between commands, the module misses ones sent closer
+
+struct AudioCommand
+{
+    uint8_t cmd;
+    uint16_t param;
+};
+
+SoftwareSerial audioSerial(AUDIO_RX_PIN, AUDIO_TX_PIN);
+
+AudioCommand audioQueue[AUDIO_QUEUE_LEN]; //audioQueue[audioHead] is the one being sent
+uint8_t audioHead = 0, audioCount = 0;
+uint8_t audioTx[AUDIO_FRAME_LEN];
+uint8_t audioTxPos = AUDIO_FRAME_LEN;     //AUDIO_FRAME_LEN when it has all been written
+elapsedMillis audioGapms;
+
+uint8_t audioTrack = 0, audioShowMode = NUM_SHOW_MODES; //what the module was last told, 0 and NUM_SHOW_MODES for nothing yet
+uint16_t audioDropped = 0;                //commands not queued, the queue was full
+
+uint16_t audio_checksum(const uint8_t *frame)
+{
+    uint16_t sum = 0;
+    for (uint8_t i = 1; i < 7; i++)
+    {
+        sum += frame[i];
+    }
+    return -sum;
+}
+
+/*--------------------------------------------------------------------------------
+  Queues a command. One replaces a command of the same kind still waiting, since
+  only the latest track and volume matter.
+--------------------------------------------------------------------------------*/
+void audio_queue(uint8_t cmd, uint16_t param)
+{
+    for (uint8_t n = 1; n < audioCount; n++) //not the head, it may be half sent
+    {
+        AudioCommand &queued = audioQueue[(audioHead + n) % AUDIO_QUEUE_LEN];
+        if (queued.cmd == cmd)
+        {
+            queued.param = param;
+            return;
+        }
+    }
+
+    if (audioCount == AUDIO_QUEUE_LEN)
+    {
+        audioDropped++;
+        return;
+    }
+
+    AudioCommand &command = audioQueue[(audioHead + audioCount++) % AUDIO_QUEUE_LEN];
+    command.cmd = cmd;
+    command.param = param;
+}
+
+void audio_play(uint8_t track)
+{
+    audioTrack = track;
+    audio_queue(AUDIO_CMD_PLAY_FOLDER, (uint16_t(SCULPTURE_ID) << 8) | track);
+}
+
+/*--------------------------------------------------------------------------------
+  Starts writing the command at the head of the queue
+--------------------------------------------------------------------------------*/
+void audio_start_frame()
+{
+    const AudioCommand &command = audioQueue[audioHead];
+
+    audioTx[0] = 0x7E;
+    audioTx[1] = 0xFF;
+    audioTx[2] = 0x06;
+    audioTx[3] = command.cmd;
+    audioTx[4] = 0x00; //no ack, it would not get through
+    audioTx[5] = command.param >> 8;
+    audioTx[6] = command.param;
+    uint16_t checksum = audio_checksum(audioTx);
+    audioTx[7] = checksum >> 8;
+    audioTx[8] = checksum;
+    audioTx[9] = 0xEF;
+
+    audioTxPos = 0;
+}
+
+/*--------------------------------------------------------------------------------
+  A play command is followed by a loop command for the same track, on for the idle
+  track and off for the others, so the head stays for it
+--------------------------------------------------------------------------------*/
+void audio_frame_sent()
+{
+    AudioCommand &command = audioQueue[audioHead];
+
+    if (command.cmd == AUDIO_CMD_PLAY_FOLDER)
+    {
+        command.cmd = AUDIO_CMD_LOOP;
+        command.param = ((command.param & 0xFF) == AUDIO_TRACK_IDLE) ? AUDIO_LOOP_ON : AUDIO_LOOP_OFF;
+        return;
+    }
+
+    audioHead = (audioHead + 1) % AUDIO_QUEUE_LEN;
+    audioCount--;
+}
+
+/*--------------------------------------------------------------------------------
+  Picks the track for the play mode changes flagged by set_playMode() and go idle
+--------------------------------------------------------------------------------*/
+void audio_on_play_mode_change()
+{
+    uint8_t track = audioTrack;
+
+    if (strip2hasPlayModeChanged && strip2playMode == BUTTON_MODE)
+    {
+        track = AUDIO_TRACK_STRIP2;
+    }
+    else if (strip1hasPlayModeChanged && strip1playMode == BUTTON_MODE)
+    {
+        track = AUDIO_TRACK_STRIP1;
+    }
+    else if (strip1playMode == IDLE_MODE && strip2playMode == IDLE_MODE)
+    {
+        track = AUDIO_TRACK_IDLE;
+    }
+
+    strip1hasPlayModeChanged = strip2hasPlayModeChanged = false;
+
+    if (track != audioTrack)
+    {
+        audio_play(track);
+    }
+}
+
+/*--------------------------------------------------------------------------------
+  Done once during setup(), which has waited long enough for the module to read its
+  SD card
+--------------------------------------------------------------------------------*/
+void audio_begin()
+{
+    audioSerial.begin(9600);
+    audioSerial.stopListening(); //no pin change interrupts for replies nobody reads
+    audioGapms = AUDIO_GAP_MS;
+}
+
+/*--------------------------------------------------------------------------------
+  Called once per loop()
+--------------------------------------------------------------------------------*/
+void audio_service()
+{
+    if (strip1hasPlayModeChanged || strip2hasPlayModeChanged)
+    {
+        audio_on_play_mode_change();
+    }
+
+    if (audioShowMode != showMode)
+    {
+        audioShowMode = showMode;
+        audio_queue(AUDIO_CMD_VOLUME, AUDIO_VOLUME[showMode]);
+    }
+    if (audioTrack == 0)
+    {
+        audio_play(AUDIO_TRACK_IDLE);
+    }
+
+    if (audioCount > 0 && audioTxPos == AUDIO_FRAME_LEN && audioGapms >= AUDIO_GAP_MS)
+    {
+        audio_start_frame();
+    }
+
+    for (uint8_t n = 0; n < AUDIO_BYTES_PER_FRAME && audioTxPos < AUDIO_FRAME_LEN; n++)
+    {
+        audioSerial.write(audioTx[audioTxPos++]);
+
+        if (audioTxPos == AUDIO_FRAME_LEN)
+        {
+            audio_frame_sent();
+            audioGapms = 0;
+        }
+    }
+}
@@ -0,0 +1,284 @@
+/*--------------------------------------------------------------------------------
+  Cycle counts of the FastLED primitives and animation VM we use, built only in the
+  bench environment (pio run -e bench -t upload, then pio device monitor). Wraps
+  main.cpp for its globals and libraries, as soak/soak.cpp does, but setup() runs
+  bench_run() instead of the sculpture, which prints a csv table and stops:
+      name,size,cycles,cycles_per_item,resolution
+  size is the number of leds (or calls, or VM instructions), cycles the best of
+  BENCH_RUNS, less the cost of timing an empty function. Timer1 counts every cycle,
+  its overflow interrupt extends it to 32 bits. Timer0's millis() interrupt is off
+  while timing, except for show(), which needs micros() for the latch wait and turns
+  interrupts off itself for most of its time. show() longer than 65536 cycles would
+  lose overflows with interrupts off, so it is timed with Timer1 counting every 8
+  cycles, resolution 8. Loops over calls (random8, random16, map) include the loop.
+
+  Compare two runs, e.g. before and after a FastLED upgrade, with
+      python3 scripts/bench_compare.py old.csv new.csv
+
+  Runs the same under simavr on Linux, with no board, where the counts are exact:
+      pio run -e bench
+      simavr -m atmega2560 -f 16000000 .pio/build/bench/firmware.elf
+  The table comes out on UART0, the lines prefixed by simavr's uart logger.
+--------------------------------------------------------------------------------*/
+
+#define setup sculpture_setup
+#define loop sculpture_loop
+#include "../main.cpp"
+#undef setup
+#undef loop
+
+const uint16_t BENCH_SIZES[] = {1, 8, 16, 25, 32, 40, 55, 64, 75, 128, 130, 256}; //our strips are 25 - 130
+const uint8_t NUM_BENCH_SIZES = sizeof(BENCH_SIZES) / sizeof(BENCH_SIZES[0]);
+const uint16_t BENCH_MAX_LEDS = 256;
+const uint8_t BENCH_RUNS = 5;
+const uint8_t BENCH_SHOW_SHIFT = 3; //show() counts every 8 cycles
+
+typedef void (*BenchFn)(uint16_t n);
+
+struct Bench
+{
+    const char *name;
+    BenchFn run;
+};
+
+CRGB benchLeds[BENCH_MAX_LEDS];
+CRGB benchColour = CRGB(40, 80, 120);
+volatile uint8_t benchSink;
+volatile uint16_t benchOverflows;
+uint32_t benchOverhead = 0;
+DataCursor benchCursor; //unused by the programs below
+
+const uint8_t BENCH_DISPATCH_PROGRAM[] PROGMEM = {OP_ADD, 0, 1, OP_JMP, 0};    //runs all VM_INSTRUCTIONS_PER_FRAME
+const uint8_t BENCH_FILL_PROGRAM[] PROGMEM = {OP_SET, 0, 200, OP_FILL, 0, OP_FADE, 32, OP_WAIT, 0, OP_JMP, 3}; //a frame of playback
+const uint8_t BENCH_WORST_PROGRAM[] PROGMEM = {OP_SET, 0, 200, OP_FILL, 0, OP_FADE, 32, OP_JMP, 3}; //never waits, held by the budget
+
+ISR(TIMER1_OVF_vect)
+{
+    benchOverflows++;
+}
+
+void bench_timer_start(uint8_t shift)
+{
+    TCCR1A = 0;
+    TCCR1B = 0;
+    TCNT1 = 0;
+    benchOverflows = 0;
+    TIFR1 = _BV(TOV1);
+    TIMSK1 = _BV(TOIE1);
+    TCCR1B = (shift == 0) ? _BV(CS10) : _BV(CS11);
+}
+
+uint32_t bench_timer_stop()
+{
+    cli();
+    TCCR1B = 0;
+    uint32_t count = (uint32_t(benchOverflows) << 16) | TCNT1;
+    if (TIFR1 & _BV(TOV1)) //overflowed since interrupts went off
+    {
+        count += 0x10000UL;
+        TIFR1 = _BV(TOV1);
+    }
+    sei();
+    return count;
+}
+
+/*--------------------------------------------------------------------------------
+  Best of BENCH_RUNS timings of fn(n), in cycles
+--------------------------------------------------------------------------------*/
+uint32_t bench_time(BenchFn fn, uint16_t n, uint8_t shift)
+{
+    uint32_t best = 0xFFFFFFFFUL;
+
+    Serial.flush(); //no TX interrupts while timing
+    for (uint8_t i = 0; i < BENCH_RUNS; i++)
+    {
+        if (shift == 0)
+        {
+            TIMSK0 &= ~_BV(TOIE0);
+        }
+        bench_timer_start(shift);
+        fn(n);
+        uint32_t cycles = bench_timer_stop() << shift;
+        TIMSK0 |= _BV(TOIE0);
+
+        best = min(best, cycles);
+    }
+    return (best > benchOverhead) ? best - benchOverhead : 0;
+}
+
+void bench_print(const char *name, uint16_t n, uint32_t cycles, uint8_t shift)
+{
+    Serial.print(name);
+    Serial.print(',');
+    Serial.print(n);
+    Serial.print(',');
+    Serial.print(cycles);
+    Serial.print(',');
+    Serial.print(float(cycles) / n, 1);
+    Serial.print(',');
+    Serial.println(1 << shift);
+}
+
+void bench_empty(uint16_t n)
+{
+}
+
+void bench_hsv2rgb_rainbow(uint16_t n)
+{
+    for (uint16_t i = 0; i < n; i++)
+    {
+        hsv2rgb_rainbow(CHSV(i, 255, 200), benchLeds[i]);
+    }
+}
+
+void bench_fill_solid(uint16_t n)
+{
+    fill_solid(benchLeds, n, benchColour);
+}
+
+void bench_nscale8(uint16_t n)
+{
+    nscale8(benchLeds, n, 200);
+}
+
+void bench_fade_to_black_by(uint16_t n)
+{
+    fadeToBlackBy(benchLeds, n, 64);
+}
+
+void bench_crgb_add(uint16_t n)
+{
+    for (uint16_t i = 0; i < n; i++)
+    {
+        benchLeds[i] += benchColour;
+    }
+}
+
+void bench_random8(uint16_t n)
+{
+    for (uint16_t i = 0; i < n; i++)
+    {
+        benchSink = random8();
+    }
+}
+
+void bench_random16(uint16_t n)
+{
+    for (uint16_t i = 0; i < n; i++)
+    {
+        benchSink = random16();
+    }
+}
+
+void bench_map(uint16_t n)
+{
+    for (uint16_t i = 0; i < n; i++)
+    {
+        benchSink = map(i, 0, 1800, 0, 255); //a dist sensor reading to a level
+    }
+}
+
+void bench_show(uint16_t n)
+{
+    FastLED[0].setLeds(benchLeds, n);
+    FastLED.show();
+}
+
+AnimVm benchVm;
+
+void bench_vm_start(const uint8_t *program, uint8_t len)
+{
+    benchVm.source = SRC_FLASH;
+    benchVm.flash = program;
+    benchVm.len = len;
+    benchVm.pc = 0;
+    benchVm.wait = 0;
+    benchVm.mode = BLEND_REPLACE;
+    benchVm.opacity = 255;
+    benchVm.isDue = false;
+    memset(benchVm.r, 0, sizeof(benchVm.r));
+}
+
+void bench_vm_dispatch(uint16_t n)
+{
+    vm_run(benchVm, benchLeds, BENCH_MAX_LEDS, benchCursor, false);
+}
+
+void bench_vm_fill_frame(uint16_t n)
+{
+    vm_run(benchVm, benchLeds, n, benchCursor, false);
+}
+
+const Bench BENCHES[] = {
+    {"hsv2rgb_rainbow", bench_hsv2rgb_rainbow},
+    {"fill_solid", bench_fill_solid},
+    {"nscale8", bench_nscale8},
+    {"fadeToBlackBy", bench_fade_to_black_by},
+    {"crgb_add", bench_crgb_add},
+    {"random8", bench_random8},
+    {"random16", bench_random16},
+    {"map", bench_map}};
+
+/*--------------------------------------------------------------------------------
+  Prints the table, never returns
+--------------------------------------------------------------------------------*/
+void bench_run()
+{
+    FastLED.addLeds<LED_TYPE, STRIP1PIN, COLOR_ORDER>(benchLeds, BENCH_MAX_LEDS);
+    FastLED.setMaxRefreshRate(0); //show() must not wait for the frame rate
+    FastLED.setBrightness(255);
+    profile.palette = AIR_QUALITY_PALETTE; //for FILL
+    fill_solid(benchLeds, BENCH_MAX_LEDS, benchColour);
+
+    benchOverhead = bench_time(bench_empty, 0, 0);
+
+    Serial.print("# bench, FastLED ");
+    Serial.print(FASTLED_VERSION);
+    Serial.print(", F_CPU ");
+    Serial.print(F_CPU);
+    Serial.print(", timing overhead ");
+    Serial.println(benchOverhead);
+    Serial.println("name,size,cycles,cycles_per_item,resolution");
+
+    for (uint8_t b = 0; b < sizeof(BENCHES) / sizeof(BENCHES[0]); b++)
+    {
+        for (uint8_t s = 0; s < NUM_BENCH_SIZES; s++)
+        {
+            bench_print(BENCHES[b].name, BENCH_SIZES[s], bench_time(BENCHES[b].run, BENCH_SIZES[s], 0), 0);
+        }
+    }
+
+    for (uint8_t s = 0; s < NUM_BENCH_SIZES; s++)
+    {
+        bench_print("show", BENCH_SIZES[s], bench_time(bench_show, BENCH_SIZES[s], BENCH_SHOW_SHIFT), BENCH_SHOW_SHIFT);
+    }
+
+    bench_vm_start(BENCH_DISPATCH_PROGRAM, sizeof(BENCH_DISPATCH_PROGRAM));
+    bench_print("vm_dispatch", VM_INSTRUCTIONS_PER_FRAME, bench_time(bench_vm_dispatch, 0, 0), 0);
+
+    for (uint8_t s = 0; s < NUM_BENCH_SIZES; s++)
+    {
+        bench_vm_start(BENCH_FILL_PROGRAM, sizeof(BENCH_FILL_PROGRAM));
+        bench_vm_fill_frame(BENCH_SIZES[s]); //SET first, then every frame is JMP, FILL, FADE, WAIT
+        bench_print("vm_fill_frame", BENCH_SIZES[s], bench_time(bench_vm_fill_frame, BENCH_SIZES[s], 0), 0);
+    }
+
+    for (uint8_t s = 0; s < NUM_BENCH_SIZES; s++)
+    {
+        bench_vm_start(BENCH_WORST_PROGRAM, sizeof(BENCH_WORST_PROGRAM));
+        bench_print("vm_worst_frame", BENCH_SIZES[s], bench_time(bench_vm_fill_frame, BENCH_SIZES[s], 0), 0);
+    }
+
+    Serial.println("# done");
+    while (1);
+}
+
+void setup()
+{
+    Serial.begin(9600);
+    bench_run();
+}
+
+void loop()
+{
+}
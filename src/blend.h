@@ -0,0 +1,67 @@
+/*--------------------------------------------------------------------------------
+  Pixel blending for the compositor layers (see compositor.h). The layer being
+  rendered sets layerMode and layerOpacity, and everything that draws goes through
+  blend_pixel() or blend_fill() so it is mixed in the way that layer asks for.
+--------------------------------------------------------------------------------*/
+
+const uint8_t BLEND_REPLACE = 0; //crossfade towards the layer by its opacity
+const uint8_t BLEND_ADD = 1;     //add the layer scaled by its opacity, saturating
+const uint8_t BLEND_MAX = 2;     //brightest of the two, per channel
+
+uint8_t layerMode = BLEND_REPLACE;
+uint8_t layerOpacity = 255;
+
+/*--------------------------------------------------------------------------------
+  src must already be scaled by layerOpacity for BLEND_ADD and BLEND_MAX, which is done
+  once per colour by blend_fill() rather than once per pixel
+--------------------------------------------------------------------------------*/
+inline void blend_scaled_pixel(CRGB &dst, const CRGB &src)
+{
+    if (layerMode == BLEND_ADD)
+    {
+        dst += src; //saturating
+    }
+    else if (layerMode == BLEND_MAX)
+    {
+        dst.r = max(dst.r, src.r);
+        dst.g = max(dst.g, src.g);
+        dst.b = max(dst.b, src.b);
+    }
+    else if (layerOpacity == 255)
+    {
+        dst = src;
+    }
+    else
+    {
+        nblend(dst, src, layerOpacity);
+    }
+}
+
+CRGB blend_prescale(CRGB src)
+{
+    if (layerMode != BLEND_REPLACE && layerOpacity != 255)
+    {
+        src.nscale8(layerOpacity);
+    }
+    return src;
+}
+
+void blend_pixel(CRGB &dst, const CRGB &src)
+{
+    blend_scaled_pixel(dst, blend_prescale(src));
+}
+
+void blend_fill(CRGB *leds, int numLeds, const CRGB &color)
+{
+    CRGB src = blend_prescale(color);
+
+    if (layerMode == BLEND_REPLACE && layerOpacity == 255)
+    {
+        fill_solid(leds, numLeds, src);
+        return;
+    }
+    for (int i = 0; i < numLeds; i++)
+    {
+        blend_scaled_pixel(leds[i], src);
+    }
+}
@@ -0,0 +1,168 @@
+/*--------------------------------------------------------------------------------
+  Render layers, drawn bottom to top every frame into the strips' own led buffers
+    pulse   : idle animation on idle strips, fade or noise (see idlenoise.h)
+    data    : playback of readings on strips in button mode
+    sparkle : glitter on idle strips
+    glow    : presence glow on idle strips, brighter the closer the visitor
+  Each layer has a blend mode and opacity (see blend.h), and adding a layer is one
+  render function and one row in the table. Playback fades its strip in place, so the
+  layers drawn on top of it only draw on idle strips, where the pulse redraws every
+  pixel each frame.
+
+  Every layer is timed with micros() (4us resolution, 64 cycles). Layers that go over
+  their budget are reported once a minute.
+--------------------------------------------------------------------------------*/
+
+const unsigned long LAYER_REPORT_MS = 60000;
+
+struct Layer
+{
+    const char *name;
+    void (*render)();
+    uint8_t mode, opacity;
+    uint16_t budgetUs;         //expected worst case
+    uint16_t lastUs, peakUs;   //measured
+    unsigned int overruns;     //frames over budget since the last report
+};
+
+void render_pulse_layer()
+{
+    if (idleStyle == IDLE_NOISE)
+    {
+        if (strip1playMode == IDLE_MODE || strip2playMode == IDLE_MODE)
+        {
+            noise_service();
+        }
+        if (strip1playMode == IDLE_MODE)
+        {
+            strip1_noise_animation();
+        }
+        if (strip2playMode == IDLE_MODE)
+        {
+            strip2_noise_animation();
+        }
+        return;
+    }
+
+    if (strip1playMode == IDLE_MODE)
+    {
+        strip1_idle_animation();
+    }
+    if (strip2playMode == IDLE_MODE)
+    {
+        strip2_idle_animation();
+    }
+}
+
+void render_data_layer()
+{
+    if (strip1playMode == BUTTON_MODE)
+    {
+        strip1_playback_readings(); //play brightness sequence according to the data set
+    }
+    if (strip2playMode == BUTTON_MODE)
+    {
+        strip2_playback_readings();
+    }
+}
+
+void render_sparkle_layer()
+{
+    profile.add_glitter();
+}
+
+void render_glow_layer()
+{
+    if (isUserPresent == false)
+    {
+        return;
+    }
+
+    uint8_t closeness = map(min(rangeVal, int(presenceRange)), 0, presenceRange, 255, 5); //right up close is 255
+
+    if (strip1playMode == IDLE_MODE)
+    {
+        blend_fill(strip1leds, strip1numLeds, CHSV(strip1Color.hue, 160, closeness));
+    }
+    if (strip2playMode == IDLE_MODE)
+    {
+        blend_fill(strip2leds, strip2numLeds, CHSV(strip2Color.hue, 160, closeness));
+    }
+}
+
+Layer layers[] = {
+    {"pulse", render_pulse_layer, BLEND_REPLACE, 255, 800, 0, 0, 0},
+    {"data", render_data_layer, BLEND_REPLACE, 255, 1000, 0, 0, 0},
+    {"sparkle", render_sparkle_layer, BLEND_ADD, 255, 100, 0, 0, 0},
+    {"glow", render_glow_layer, BLEND_ADD, 96, 800, 0, 0, 0}};
+
+const uint8_t NUM_LAYERS = sizeof(layers) / sizeof(layers[0]);
+const uint8_t LAYER_PULSE = 0, LAYER_DATA = 1, LAYER_SPARKLE = 2, LAYER_GLOW = 3; //index in layers
+
+elapsedMillis layerReportms;
+
+void print_layer_costs()
+{
+    for (uint8_t i = 0; i < NUM_LAYERS; i++)
+    {
+        debugSerial.print("layer ");
+        debugSerial.print(layers[i].name);
+        debugSerial.print(": last ");
+        debugSerial.print(layers[i].lastUs);
+        debugSerial.print("us, peak ");
+        debugSerial.print(layers[i].peakUs);
+        debugSerial.print("us, budget ");
+        debugSerial.print(layers[i].budgetUs);
+        debugSerial.print("us, overruns ");
+        debugSerial.println(layers[i].overruns);
+    }
+}
+
+/*--------------------------------------------------------------------------------
+  Called once per loop(), replaces the fixed idle/playback/glitter sequence
+--------------------------------------------------------------------------------*/
+void render_layers()
+{
+    bool isOverBudget = false;
+
+    for (uint8_t i = 0; i < NUM_LAYERS; i++)
+    {
+        Layer &layer = layers[i];
+
+        if (layer.opacity == 0)
+        {
+            continue;
+        }
+
+        layerMode = layer.mode;
+        layerOpacity = layer.opacity;
+
+        unsigned long start = micros();
+        layer.render();
+        layer.lastUs = micros() - start;
+
+        if (layer.lastUs > layer.peakUs)
+        {
+            layer.peakUs = layer.lastUs;
+        }
+        if (layer.lastUs > layer.budgetUs)
+        {
+            layer.overruns++;
+        }
+        isOverBudget |= (layer.overruns > 0);
+    }
+
+    if (layerReportms > LAYER_REPORT_MS)
+    {
+        if (isOverBudget)
+        {
+            print_layer_costs();
+            for (uint8_t i = 0; i < NUM_LAYERS; i++)
+            {
+                layers[i].overruns = 0;
+                layers[i].peakUs = 0;
+            }
+        }
+        layerReportms = 0;
+    }
+}
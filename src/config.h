@@ -0,0 +1,249 @@
+/*--------------------------------------------------------------------------------
+  Configuration store. Everything kept over a reset that is not a data set, program
+  or cue table (sculpture ID, tuning console parameters) is one record, laid out as
+      seq, version, len, payload[len], crc8 over version..payload
+  Records go round a log of CONFIG_SLOTS fixed size slots, each save into the slot
+  after the newest, so the cells wear CONFIG_SLOTS times slower. A save first marks
+  its slot empty (seq 0xFF) and writes seq last, so a brownout half way leaves a
+  record that fails its crc or is marked empty, and the one before it is used.
+
+  At boot every slot is checked once, a fixed number of reads, and the valid one with
+  the highest seq (counting on from the others, seq wraps) is the newest.
+  test/host/config_check.cpp checks the rotation and torn saves on a PC.
+
+  Payload, CONFIG_VERSION 1
+      [CONFIG_SCULPTURE_ID]  sculpture ID
+      [CONFIG_PARAMS ..]     tuning console parameters in table order (see console.h)
+  New parameters go on the end with the version unchanged, older records just have
+  fewer of them. Anything else bumps the version and gets a step in config_migrate().
+  Before the log, the ID was a byte at 0 and the parameters a block at 0x010. When
+  there is no record those are read once and saved as the first one.
+--------------------------------------------------------------------------------*/
+
+const uint8_t CONFIG_VERSION = 1;
+const uint8_t CONFIG_SLOT_SIZE = 32;
+const uint8_t CONFIG_SLOTS = EEPROM_CONFIG_SIZE / CONFIG_SLOT_SIZE;
+const uint8_t CONFIG_RECORD_OVERHEAD = 4; //seq, version, len, crc
+const uint8_t CONFIG_PAYLOAD_MAX = CONFIG_SLOT_SIZE - CONFIG_RECORD_OVERHEAD;
+const uint8_t CONFIG_EMPTY = 0xFF;        //seq of a slot being written, and of blank EEPROM
+
+const uint8_t CONFIG_SCULPTURE_ID = 0, CONFIG_PARAMS = 1;
+
+const int CONFIG_LEGACY_PROFILE_ADDR = 0, CONFIG_LEGACY_PARAMS_ADDR = 0x010;
+const uint8_t CONFIG_LEGACY_PARAMS_MAGIC = 0xB3;
+
+struct LegacyParamsHeader //at CONFIG_LEGACY_PARAMS_ADDR, followed by the values
+{
+    uint8_t len;
+    uint8_t crc;
+    uint8_t magic;
+};
+
+uint8_t configPayload[CONFIG_PAYLOAD_MAX]; //newest record, what is being saved
+uint8_t configLen = 0;                     //0 if nothing was ever saved
+uint8_t configSeq = CONFIG_EMPTY;          //of the newest record
+uint8_t configNextSlot = 0;
+
+uint8_t configImage[CONFIG_SLOT_SIZE];     //record being written, laid out as in EEPROM
+uint8_t configWriteStep = 0, configWriteSteps = 0;
+
+int config_slot_addr(uint8_t slot)
+{
+    return EEPROM_CONFIG_ADDR + slot * CONFIG_SLOT_SIZE;
+}
+
+/*--------------------------------------------------------------------------------
+  Reads a slot's record into configPayload if it is valid. Returns its version, 0 if
+  it is not valid.
+--------------------------------------------------------------------------------*/
+uint8_t config_read_slot(uint8_t slot, uint8_t &seq)
+{
+    int addr = config_slot_addr(slot);
+    seq = EEPROM.read(addr);
+    uint8_t version = EEPROM.read(addr + 1);
+    uint8_t len = EEPROM.read(addr + 2);
+
+    if (seq == CONFIG_EMPTY || version == 0 || len > CONFIG_PAYLOAD_MAX)
+    {
+        return 0;
+    }
+
+    uint8_t crc = crc8_update(crc8_update(0, version), len);
+    for (uint8_t i = 0; i < len; i++)
+    {
+        crc = crc8_update(crc, EEPROM.read(addr + 3 + i));
+    }
+    if (crc != EEPROM.read(addr + 3 + len))
+    {
+        return 0;
+    }
+
+    for (uint8_t i = 0; i < len; i++)
+    {
+        configPayload[i] = EEPROM.read(addr + 3 + i);
+    }
+    configLen = len;
+    return version;
+}
+
+/*--------------------------------------------------------------------------------
+  Brings configPayload of an older version up to CONFIG_VERSION, which is then saved
+  in the new layout. Nothing to do yet.
+--------------------------------------------------------------------------------*/
+void config_migrate(uint8_t version)
+{
+    (void)version;
+}
+
+/*--------------------------------------------------------------------------------
+  The ID byte and parameter block from before the log
+--------------------------------------------------------------------------------*/
+bool config_read_legacy()
+{
+    uint8_t id = EEPROM.read(CONFIG_LEGACY_PROFILE_ADDR);
+    LegacyParamsHeader header;
+    EEPROM.get(CONFIG_LEGACY_PARAMS_ADDR, header);
+
+    if (id < CO2_ID || id > VOC_ID)
+    {
+        return false;
+    }
+    configPayload[CONFIG_SCULPTURE_ID] = id;
+    configLen = CONFIG_PARAMS;
+
+    if (header.magic != CONFIG_LEGACY_PARAMS_MAGIC || header.len > CONFIG_PAYLOAD_MAX - CONFIG_PARAMS)
+    {
+        return true;
+    }
+
+    int addr = CONFIG_LEGACY_PARAMS_ADDR + sizeof(LegacyParamsHeader);
+    uint8_t crc = 0;
+    for (uint8_t i = 0; i < header.len; i++)
+    {
+        configPayload[CONFIG_PARAMS + i] = EEPROM.read(addr + i);
+        crc = crc8_update(crc, configPayload[CONFIG_PARAMS + i]);
+    }
+    if (crc == header.crc)
+    {
+        configLen += header.len;
+    }
+    return true;
+}
+
+/*--------------------------------------------------------------------------------
+  Lays out configPayload as a record in the next slot, for config_service() to write
+--------------------------------------------------------------------------------*/
+void config_save()
+{
+    uint8_t seq = configSeq + 1;
+    if (seq == CONFIG_EMPTY)
+    {
+        seq = 0;
+    }
+
+    configImage[0] = seq;
+    configImage[1] = CONFIG_VERSION;
+    configImage[2] = configLen;
+    memcpy(configImage + 3, configPayload, configLen);
+
+    uint8_t crc = 0;
+    for (uint8_t i = 1; i < 3 + configLen; i++)
+    {
+        crc = crc8_update(crc, configImage[i]);
+    }
+    configImage[3 + configLen] = crc;
+
+    configWriteSteps = configLen + CONFIG_RECORD_OVERHEAD + 1; //seq written twice, empty first
+    configWriteStep = 0;
+}
+
+/*--------------------------------------------------------------------------------
+  One EEPROM byte of a save, seq marked empty, then the rest, then seq
+--------------------------------------------------------------------------------*/
+void config_write_step()
+{
+    int addr = config_slot_addr(configNextSlot);
+
+    if (configWriteStep == 0)
+    {
+        EEPROM.update(addr, CONFIG_EMPTY);
+    }
+    else if (configWriteStep < configWriteSteps - 1)
+    {
+        EEPROM.update(addr + configWriteStep, configImage[configWriteStep]);
+    }
+    else
+    {
+        EEPROM.update(addr, configImage[0]);
+        configSeq = configImage[0];
+        configNextSlot = (configNextSlot + 1) % CONFIG_SLOTS;
+        debugSerial.println("config saved");
+    }
+    configWriteStep++;
+}
+
+/*--------------------------------------------------------------------------------
+  Finishes a save straight away, only for setup()
+--------------------------------------------------------------------------------*/
+void config_write_now()
+{
+    while (configWriteStep < configWriteSteps)
+    {
+        config_write_step();
+    }
+}
+
+/*--------------------------------------------------------------------------------
+  Done first thing in setup(). Finds the newest record, or migrates the old layout.
+--------------------------------------------------------------------------------*/
+void config_begin()
+{
+    int8_t newest = -1;
+    uint8_t newestVersion = 0;
+
+    for (uint8_t slot = 0; slot < CONFIG_SLOTS; slot++)
+    {
+        uint8_t seq;
+        if (config_read_slot(slot, seq) == 0)
+        {
+            continue;
+        }
+        if (newest < 0 || int8_t(seq - configSeq) > 0)
+        {
+            newest = slot;
+            configSeq = seq;
+        }
+    }
+
+    if (newest >= 0)
+    {
+        newestVersion = config_read_slot(newest, configSeq); //the scan leaves the last valid one in configPayload
+        configNextSlot = (newest + 1) % CONFIG_SLOTS;
+
+        if (newestVersion < CONFIG_VERSION)
+        {
+            config_migrate(newestVersion);
+            config_save();
+            config_write_now();
+        }
+        return;
+    }
+
+    if (config_read_legacy())
+    {
+        debugSerial.println("config moved to the log");
+        config_save();
+        config_write_now();
+    }
+}
+
+/*--------------------------------------------------------------------------------
+  Called once per loop(). Writes at most one EEPROM byte of a save.
+--------------------------------------------------------------------------------*/
+void config_service()
+{
+    if (configWriteStep < configWriteSteps)
+    {
+        config_write_step();
+    }
+}
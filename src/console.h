@@ -0,0 +1,316 @@
+/*--------------------------------------------------------------------------------
+  Tuning console on the debug serial port, 9600 baud, lines ending in newline
+    list                : every parameter with its value and range
+    get <name>          : one parameter
+    set <name> <value>  : changes it, from the next frame on. linked and playback
+                          only while both strips are idle, a playback keeps its own.
+    save                : keeps the current values over a reset (see config.h)
+    rec save|play|stop  : black box recorder (see recorder.h)
+    view on|off         : frame dump for scripts/led_viewer.py (see viewer.h)
+
+  Text shares the port with the upload frames. upload_service() hands over every byte
+  that comes while it is waiting for a frame, and 0xA5 never turns up in text. So the
+  parser costs one buffer append per byte, within the upload's bytes per loop().
+  A finished line is run by console_service() at the top of the next loop(), between
+  frames. Replies that do not fit in the serial TX buffer wait for a later loop(), so
+  list prints one parameter per loop(), help one line, and printing never waits either.
+
+  Only add parameters to the end of the table, the saved values are kept in its order.
+--------------------------------------------------------------------------------*/
+
+const uint8_t PARAM_U8 = 0, PARAM_U16 = 1, PARAM_BOOL = 2;
+const uint8_t CONSOLE_LINE_MAX = 32;
+const uint8_t CONSOLE_REPLY_MAX = 40; //free TX buffer needed to print a reply
+
+struct Param
+{
+    const char *name;
+    uint8_t type;
+    void *value;
+    uint16_t min, max;
+};
+
+const char PARAM_BAND_DELAY[] PROGMEM = "band_delay";
+const char PARAM_PRESENCE[] PROGMEM = "presence_mm";
+const char PARAM_ACTIVE_HUE[] PROGMEM = "active_hue";
+const char PARAM_ACTIVE_SAT[] PROGMEM = "active_sat";
+const char PARAM_IDLE_HUE[] PROGMEM = "idle_hue";
+const char PARAM_IDLE_SAT[] PROGMEM = "idle_sat";
+const char PARAM_GLITTER[] PROGMEM = "glitter";
+const char PARAM_IDLE_STYLE[] PROGMEM = "idle_style";
+const char PARAM_PLAYBACK[] PROGMEM = "playback";
+const char PARAM_PROGRAM[] PROGMEM = "program";
+const char PARAM_LINKED[] PROGMEM = "linked";
+const char PARAM_MIRROR[] PROGMEM = "mirror";
+
+const Param PARAMS[] PROGMEM = {
+    {PARAM_BAND_DELAY, PARAM_U16, &bandDelay, 40, 5000},
+    {PARAM_PRESENCE, PARAM_U16, &presenceRange, 100, 2000},
+    {PARAM_ACTIVE_HUE, PARAM_U8, &activeColor.hue, 0, 255},
+    {PARAM_ACTIVE_SAT, PARAM_U8, &activeColor.sat, 0, 255},
+    {PARAM_IDLE_HUE, PARAM_U8, &idleColor.hue, 0, 255},
+    {PARAM_IDLE_SAT, PARAM_U8, &idleColor.sat, 0, 255},
+    {PARAM_GLITTER, PARAM_U8, &profile.glitterChance, 0, 255},
+    {PARAM_IDLE_STYLE, PARAM_U8, &idleStyle, IDLE_PULSE, IDLE_NOISE},
+    {PARAM_PLAYBACK, PARAM_U8, &playbackStyle, PLAYBACK_FILL, PLAYBACK_PROGRAM},
+    {PARAM_PROGRAM, PARAM_U8, &playbackProgram, 0, NUM_ANIM_PROGRAMS - 1},
+    {PARAM_LINKED, PARAM_BOOL, &isLinkedPlayback, 0, 1},
+    {PARAM_MIRROR, PARAM_BOOL, &isSyncMirror, 0, 1}};
+
+const uint8_t NUM_PARAMS = sizeof(PARAMS) / sizeof(PARAMS[0]);
+
+const char HELP_0[] PROGMEM = "commands: list, get <name>";
+const char HELP_1[] PROGMEM = "set <name> <value>, save";
+const char HELP_2[] PROGMEM = "rec save|play|stop, view on|off";
+
+const char *const CONSOLE_HELP[] PROGMEM = {HELP_0, HELP_1, HELP_2}; //a line per loop(), each under CONSOLE_REPLY_MAX
+const uint8_t NUM_HELP_LINES = sizeof(CONSOLE_HELP) / sizeof(CONSOLE_HELP[0]);
+
+char consoleLine[CONSOLE_LINE_MAX + 1];
+uint8_t consoleLineLen = 0;
+bool isConsoleLineReady = false, isConsoleLineTooLong = false;
+int8_t consoleListNext = -1;            //next parameter to list, -1 if not listing
+int8_t consoleHelpNext = -1;            //next help line, -1 if not printing help
+
+Param param_entry(uint8_t index)
+{
+    Param param;
+    memcpy_P(&param, &PARAMS[index], sizeof(Param));
+    return param;
+}
+
+uint16_t param_get(const Param &param)
+{
+    if (param.type == PARAM_U16)
+    {
+        return *(uint16_t *)param.value;
+    }
+    if (param.type == PARAM_BOOL)
+    {
+        return *(bool *)param.value;
+    }
+    return *(uint8_t *)param.value;
+}
+
+void param_set(const Param &param, long value)
+{
+    value = constrain(value, long(param.min), long(param.max));
+
+    if (param.type == PARAM_U16)
+    {
+        *(uint16_t *)param.value = value;
+    }
+    else if (param.type == PARAM_BOOL)
+    {
+        *(bool *)param.value = (value != 0);
+    }
+    else
+    {
+        *(uint8_t *)param.value = value;
+    }
+}
+
+/*--------------------------------------------------------------------------------
+  Parameters that change how a playback runs, set only while both strips are idle
+--------------------------------------------------------------------------------*/
+bool param_needs_idle(const Param &param)
+{
+    return param.value == &isLinkedPlayback || param.value == &playbackStyle;
+}
+
+int8_t param_find(const char *name)
+{
+    for (uint8_t i = 0; i < NUM_PARAMS; i++)
+    {
+        if (strcmp_P(name, (const char *)pgm_read_ptr(&PARAMS[i].name)) == 0)
+        {
+            return i;
+        }
+    }
+    return -1;
+}
+
+void param_print(uint8_t index)
+{
+    Param param = param_entry(index);
+
+    Serial.print((const __FlashStringHelper *)param.name);
+    Serial.print(" = ");
+    Serial.print(param_get(param));
+    Serial.print(" (");
+    Serial.print(param.min);
+    Serial.print(" - ");
+    Serial.print(param.max);
+    Serial.println(")");
+}
+
+/*--------------------------------------------------------------------------------
+  Done once during setup(), after load_profile() so a saved glitter chance replaces
+  the profile's. The saved values are 1 or 2 bytes each in table order, those saved
+  by an older firmware with fewer parameters are loaded as far as they go.
+--------------------------------------------------------------------------------*/
+void params_load()
+{
+    uint8_t pos = CONFIG_PARAMS;
+
+    for (uint8_t i = 0; i < NUM_PARAMS; i++)
+    {
+        Param param = param_entry(i);
+        uint8_t size = (param.type == PARAM_U16) ? 2 : 1;
+
+        if (pos + size > configLen)
+        {
+            break;
+        }
+        param_set(param, (size == 2) ? configPayload[pos] | (configPayload[pos + 1] << 8) : configPayload[pos]);
+        pos += size;
+    }
+}
+
+void params_save()
+{
+    configLen = CONFIG_PARAMS;
+
+    for (uint8_t i = 0; i < NUM_PARAMS && configLen + 2 <= CONFIG_PAYLOAD_MAX; i++)
+    {
+        Param param = param_entry(i);
+        uint16_t value = param_get(param);
+
+        configPayload[configLen++] = value;
+        if (param.type == PARAM_U16)
+        {
+            configPayload[configLen++] = value >> 8;
+        }
+    }
+    configPayload[CONFIG_SCULPTURE_ID] = SCULPTURE_ID;
+    config_save();
+}
+
+/*--------------------------------------------------------------------------------
+  Feeds one byte of text, from upload_service()
+--------------------------------------------------------------------------------*/
+void console_parse_byte(uint8_t c)
+{
+    if (isConsoleLineReady)
+    {
+        return; //last line not run yet, a person typing never gets here
+    }
+    if (c == '\n' || c == '\r')
+    {
+        if (consoleLineLen > 0 && !isConsoleLineTooLong)
+        {
+            consoleLine[consoleLineLen] = '\0';
+            isConsoleLineReady = true;
+        }
+        consoleLineLen = 0;
+        isConsoleLineTooLong = false;
+    }
+    else if (consoleLineLen < CONSOLE_LINE_MAX)
+    {
+        consoleLine[consoleLineLen++] = c;
+    }
+    else
+    {
+        isConsoleLineTooLong = true;
+    }
+}
+
+void console_run_line()
+{
+    char *command = strtok(consoleLine, " ");
+    char *name = strtok(NULL, " ");
+    char *value = strtok(NULL, " ");
+    int8_t index = (name != NULL) ? param_find(name) : -1;
+
+    if (command == NULL)
+    {
+        return;
+    }
+    if (strcmp(command, "list") == 0)
+    {
+        consoleListNext = 0;
+    }
+    else if (strcmp(command, "rec") == 0 && name != NULL)
+    {
+        if (strcmp(name, "save") == 0)
+        {
+            rec_save();
+        }
+        else if (strcmp(name, "play") == 0 && replay_start())
+        {
+            Serial.println("replaying");
+        }
+        else if (strcmp(name, "stop") == 0 && isReplaying)
+        {
+            replay_stop();
+        }
+    }
+    else if (strcmp(command, "view") == 0 && name != NULL)
+    {
+        isViewing = (strcmp(name, "on") == 0);
+    }
+    else if (strcmp(command, "save") == 0)
+    {
+        params_save();
+        Serial.println("saving");
+    }
+    else if (strcmp(command, "get") == 0 && index >= 0)
+    {
+        param_print(index);
+    }
+    else if (strcmp(command, "set") == 0 && index >= 0 && value != NULL)
+    {
+        Param param = param_entry(index);
+
+        if (param_needs_idle(param) && (strip1playMode != IDLE_MODE || strip2playMode != IDLE_MODE))
+        {
+            Serial.println("wait for both strips to be idle");
+        }
+        else
+        {
+            param_set(param, atol(value));
+            param_print(index);
+        }
+    }
+    else if (name != NULL && index < 0)
+    {
+        Serial.println("no such parameter, try list");
+    }
+    else
+    {
+        consoleHelpNext = 0;
+    }
+}
+
+/*--------------------------------------------------------------------------------
+  Called once per loop(), before anything uses the parameters
+--------------------------------------------------------------------------------*/
+void console_service()
+{
+    if (Serial.availableForWrite() < CONSOLE_REPLY_MAX)
+    {
+        return;
+    }
+
+    if (consoleListNext >= 0)
+    {
+        param_print(consoleListNext++);
+        if (consoleListNext == NUM_PARAMS)
+        {
+            consoleListNext = -1;
+        }
+    }
+    else if (consoleHelpNext >= 0)
+    {
+        Serial.println((const __FlashStringHelper *)pgm_read_ptr(&CONSOLE_HELP[consoleHelpNext++]));
+        if (consoleHelpNext == NUM_HELP_LINES)
+        {
+            consoleHelpNext = -1;
+        }
+    }
+    else if (isConsoleLineReady)
+    {
+        console_run_line();
+        isConsoleLineReady = false;
+    }
+}
@@ -0,0 +1,13 @@
+/*--------------------------------------------------------------------------------
+  CRC-8, polynomial 0x07, used by the serial upload (upload.h) and sync (sync.h)
+  protocols
+--------------------------------------------------------------------------------*/
+uint8_t crc8_update(uint8_t crc, uint8_t data)
+{
+    crc ^= data;
+    for (uint8_t i = 0; i < 8; i++)
+    {
+        crc = (crc & 0x80) ? (crc << 1) ^ 0x07 : (crc << 1);
+    }
+    return crc;
+}
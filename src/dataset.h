@@ -0,0 +1,296 @@
+/*--------------------------------------------------------------------------------
+  Playback data sources. In live mode (see livesensor.h) a button plays the sensor's
+  recent history, the last HISTORY_WINDOW_MINUTES at the matching resolution (see
+  history.h). Otherwise it plays, in order of preference, the data set uploaded over
+  serial to its EEPROM slot (see upload.h), the data set in its slot of the external
+  SPI flash (see spiflash.h) or the sculpture's built in data set, a flash table of
+  brightness values generated from the csv files in datasets/. Playback only ever
+  steps forward, so a cursor decodes one value per step in place and RAM use does
+  not grow with the length of the data set.
+
+  SPI flash is read in SPIFLASH_CHUNK byte chunks into two buffers. Playback decodes
+  from one while dataset_service() fills the other from loop(), so the playback code
+  never waits on the chip.
+
+  Formats
+    FORMAT_BRIGHT8 : brightness value per sample, already mapped (built in data sets)
+    FORMAT_RAW16 : little endian int16 per sample
+    FORMAT_DZV   : delta to the previous sample (0 before the first), zigzag
+                   encoded so small negative steps stay small, then as a varint of
+                   7 bits per byte with the top bit set on all but the last byte.
+                   Air quality series are smooth, so most samples take 1 byte
+                   instead of 2.
+
+  EEPROM and SPI flash slot layout: DatasetHeader followed by size bytes of data. The
+  magic byte is the last byte of the header and is written last, so a half finished
+  upload is never played.
+--------------------------------------------------------------------------------*/
+
+const uint8_t SRC_FLASH = 0, SRC_EEPROM = 1, SRC_SPIFLASH = 2, SRC_HISTORY = 3;
+const uint8_t FORMAT_RAW16 = 0, FORMAT_DZV = 1, FORMAT_BRIGHT8 = 2;
+const uint8_t DATASET_MAGIC = 0xD6;
+
+struct DatasetHeader
+{
+    uint8_t format;
+    uint16_t count;         //number of samples
+    uint16_t size;          //bytes of sample data after the header
+    int16_t inMin, inMax;   //range of the raw data
+    int16_t outMin, outMax; //brightness range it maps to
+    uint8_t magic;
+};
+
+const int DATASET_MAX_SIZE = EEPROM_DATASET_SIZE - sizeof(DatasetHeader);
+const uint8_t DZV_MAX_BYTES = 3; //a 16 bit delta zigzags to 17 bits
+const uint8_t SPIFLASH_CHUNK = 32;
+const unsigned int HISTORY_WINDOW_MINUTES[2] = {60, 24 * 60}; //per button: last hour, last day
+
+struct DataCursor
+{
+    uint8_t source, format;
+    unsigned int len, pos;
+    const uint8_t *flash; //SRC_FLASH: next byte
+    int addr;             //SRC_EEPROM: next byte
+    uint32_t spiAddr;     //SRC_SPIFLASH: start of the next chunk to prefetch
+    uint32_t spiEnd;
+    uint8_t spiBuf[2][SPIFLASH_CHUNK];
+    uint8_t spiActive, spiPos; //buffer being decoded and position in it
+    bool isSpiNextReady;
+    uint8_t historyLevel; //SRC_HISTORY
+    int prev;             //last decoded raw value, for FORMAT_DZV
+    int inMin, inMax, outMin, outMax;
+};
+
+DataCursor strip1data, strip2data;
+uint8_t catalogueIndex[2]; //per button, entry played by the next press
+unsigned int spiflashUnderruns = 0; //times playback had to wait for a chunk, should stay 0
+
+int dataset_slot_addr(uint8_t slot)
+{
+    return EEPROM_DATASET_ADDR + slot * EEPROM_DATASET_SIZE;
+}
+
+bool dataset_slot_valid(uint8_t slot, DatasetHeader &header)
+{
+    EEPROM.get(dataset_slot_addr(slot), header);
+
+    return header.magic == DATASET_MAGIC && header.format == FORMAT_DZV && header.count > 0 && header.size <= DATASET_MAX_SIZE && header.inMax != header.inMin;
+}
+
+bool dataset_spiflash_slot_valid(uint8_t slot, DatasetHeader &header)
+{
+    if (!isSpiflashPresent)
+    {
+        return false;
+    }
+
+    spiflash_read(slot * SPIFLASH_SLOT_SIZE, (uint8_t *)&header, sizeof(header));
+
+    return header.magic == DATASET_MAGIC && header.format <= FORMAT_DZV && header.count > 0 && header.size <= SPIFLASH_SLOT_SIZE - sizeof(header) && header.inMax != header.inMin;
+}
+
+/*--------------------------------------------------------------------------------
+  Fills the buffer that is not being decoded with the next chunk of SPI flash
+--------------------------------------------------------------------------------*/
+void dataset_prefetch(DataCursor &cursor)
+{
+    if (cursor.spiAddr < cursor.spiEnd)
+    {
+        spiflash_read(cursor.spiAddr, cursor.spiBuf[cursor.spiActive ^ 1], SPIFLASH_CHUNK);
+        cursor.spiAddr += SPIFLASH_CHUNK;
+    }
+    cursor.isSpiNextReady = true;
+}
+
+/*--------------------------------------------------------------------------------
+  Called once per loop() for each cursor. Does at most one chunk read (~50us).
+--------------------------------------------------------------------------------*/
+void dataset_service(DataCursor &cursor)
+{
+    if (cursor.source == SRC_SPIFLASH && !cursor.isSpiNextReady)
+    {
+        dataset_prefetch(cursor);
+    }
+}
+
+/*--------------------------------------------------------------------------------
+  Delta zigzag varint encoding. Writes the encoded value to out and returns its length.
+--------------------------------------------------------------------------------*/
+uint8_t dzv_encode(int value, int &prev, uint8_t *out)
+{
+    long delta = long(value) - prev;
+    unsigned long zigzag = (delta < 0) ? ((unsigned long)(-delta) << 1) - 1 : (unsigned long)delta << 1;
+    uint8_t n = 0;
+
+    prev = value;
+
+    while (zigzag >= 0x80)
+    {
+        out[n++] = uint8_t(zigzag) | 0x80;
+        zigzag >>= 7;
+    }
+    out[n++] = uint8_t(zigzag);
+    return n;
+}
+
+/*--------------------------------------------------------------------------------
+  Points the cursor at the next data set for a button (slot 0 or 1), see the top of
+  the file for the order
+--------------------------------------------------------------------------------*/
+void dataset_open(uint8_t slot, DataCursor &cursor)
+{
+    DatasetHeader header;
+
+    cursor.pos = 0;
+    cursor.prev = 0;
+    cursor.source = SRC_FLASH;
+
+    uint8_t level = history_level_for(HISTORY_WINDOW_MINUTES[slot]);
+    uint8_t historyLen = min(HISTORY_WINDOW_MINUTES[slot] / HISTORY_BUCKET_MINUTES[level], historyCount[level]);
+
+    while (historyLen > 0 && history_is_empty(history_get(level, historyLen - 1))) //start at the oldest with readings
+    {
+        historyLen--;
+    }
+
+    if (isLiveMode && historyLen > 0)
+    {
+        cursor.source = SRC_HISTORY;
+        cursor.historyLevel = level;
+        cursor.len = historyLen;
+        cursor.prev = history_get(level, cursor.len - 1).mean;
+        cursor.inMin = liveScale.inMin;
+        cursor.inMax = liveScale.inMax;
+        cursor.outMin = liveScale.outMin;
+        cursor.outMax = liveScale.outMax;
+        return;
+    }
+
+    bool isInEeprom = dataset_slot_valid(slot, header);
+    uint8_t numStored = (isInEeprom || dataset_spiflash_slot_valid(slot, header)) ? 1 : 0;
+
+    if (catalogueIndex[slot] >= profile.catalogueLen[slot] + numStored) //stored data set has been erased
+    {
+        catalogueIndex[slot] = 0;
+    }
+
+    if (numStored == 1 && catalogueIndex[slot] == 0)
+    {
+        if (isInEeprom)
+        {
+            cursor.source = SRC_EEPROM;
+            cursor.addr = dataset_slot_addr(slot) + sizeof(DatasetHeader);
+        }
+        else
+        {
+            cursor.source = SRC_SPIFLASH;
+            cursor.spiAddr = slot * SPIFLASH_SLOT_SIZE + sizeof(DatasetHeader);
+            cursor.spiEnd = cursor.spiAddr + header.size;
+            cursor.spiActive = 1;
+            cursor.spiPos = 0;
+            dataset_prefetch(cursor); //first chunk is read straight away, into buffer 0
+            cursor.spiActive = 0;
+            cursor.isSpiNextReady = false;
+        }
+
+        cursor.format = header.format;
+        cursor.len = header.count;
+        cursor.inMin = header.inMin;
+        cursor.inMax = header.inMax;
+        cursor.outMin = header.outMin;
+        cursor.outMax = header.outMax;
+    }
+    else
+    {
+        FlashDataset builtin;
+        memcpy_P(&builtin, pgm_read_ptr(&profile.catalogue[slot][catalogueIndex[slot] - numStored]), sizeof(FlashDataset));
+
+        cursor.format = FORMAT_BRIGHT8;
+        cursor.len = builtin.len;
+        cursor.flash = builtin.values;
+    }
+
+    debugSerial.print("data set ");
+    debugSerial.print(catalogueIndex[slot] + 1);
+    debugSerial.print(" of ");
+    debugSerial.println(profile.catalogueLen[slot] + numStored);
+
+    catalogueIndex[slot] = (catalogueIndex[slot] + 1) % (profile.catalogueLen[slot] + numStored); //next press
+}
+
+bool dataset_done(DataCursor &cursor)
+{
+    return cursor.pos >= cursor.len;
+}
+
+uint8_t dataset_read_byte(DataCursor &cursor)
+{
+    if (cursor.source == SRC_EEPROM)
+    {
+        return EEPROM.read(cursor.addr++);
+    }
+    else if (cursor.source == SRC_SPIFLASH)
+    {
+        if (cursor.spiPos == SPIFLASH_CHUNK) //move on to the prefetched buffer
+        {
+            if (!cursor.isSpiNextReady)
+            {
+                spiflashUnderruns++;
+                dataset_prefetch(cursor);
+            }
+            cursor.spiActive ^= 1;
+            cursor.spiPos = 0;
+            cursor.isSpiNextReady = false;
+        }
+        return cursor.spiBuf[cursor.spiActive][cursor.spiPos++];
+    }
+    return pgm_read_byte(cursor.flash++);
+}
+
+/*--------------------------------------------------------------------------------
+  Returns the brightness value at the cursor and moves on to the next one
+--------------------------------------------------------------------------------*/
+int dataset_next(DataCursor &cursor)
+{
+    if (dataset_done(cursor))
+    {
+        return 0;
+    }
+
+    cursor.pos++;
+
+    if (cursor.source == SRC_HISTORY) //oldest bucket first, an empty one repeats the last value
+    {
+        const HistoryBucket &bucket = history_get(cursor.historyLevel, cursor.len - cursor.pos);
+        if (!history_is_empty(bucket))
+        {
+            cursor.prev = bucket.mean;
+        }
+    }
+    else if (cursor.format == FORMAT_BRIGHT8)
+    {
+        return dataset_read_byte(cursor);
+    }
+    else if (cursor.format == FORMAT_RAW16)
+    {
+        uint8_t lo = dataset_read_byte(cursor);
+        cursor.prev = int16_t(lo | (dataset_read_byte(cursor) << 8));
+    }
+    else //FORMAT_DZV
+    {
+        unsigned long zigzag = 0;
+        uint8_t shift = 0, c;
+
+        do
+        {
+            c = dataset_read_byte(cursor);
+            zigzag |= (unsigned long)(c & 0x7F) << shift;
+            shift += 7;
+        } while ((c & 0x80) && shift < 7 * DZV_MAX_BYTES);
+
+        long delta = (zigzag & 1) ? -long((zigzag + 1) >> 1) : long(zigzag >> 1);
+        cursor.prev += int(delta);
+    }
+
+    return constrain(int(map(cursor.prev, cursor.inMin, cursor.inMax, cursor.outMin, cursor.outMax)), 0, 255);
+}
@@ -0,0 +1,59 @@
+// Generated by scripts/gen_datasets.py from datasets/*.csv, do not edit.
+
+#pragma once
+
+struct FlashDataset
+{
+    const uint8_t *values; //brightness values, already mapped
+    uint16_t len;
+    int16_t inMin, inMax;  //range of the raw data
+    uint8_t outMin, outMax; //brightness range it was mapped to
+    const char *units;     //in flash
+};
+
+// co2_1.csv, 17 readings, ppm 0-1800 mapped to 64-255
+const uint8_t CO2_1_VALUES[17] PROGMEM = {
+    234, 125, 107, 108, 111, 107, 106, 107, 107, 107, 107, 107, 108, 107, 108, 110, 108};
+const char CO2_1_UNITS[] PROGMEM = "ppm";
+const FlashDataset CO2_1 PROGMEM = {CO2_1_VALUES, 17, 0, 1800, 64, 255, CO2_1_UNITS};
+
+// co2_2.csv, 40 readings, ppm 0-1800 mapped to 64-255
+const uint8_t CO2_2_VALUES[40] PROGMEM = {
+    242, 132, 129, 138, 137, 146, 111, 134, 132, 135, 109, 117, 122, 115, 131, 163, 254, 117, 141, 137,
+    126, 128, 154, 146, 255, 132, 132, 133, 158, 108, 112, 138, 139, 158, 174, 112, 115, 117, 111, 122};
+const char CO2_2_UNITS[] PROGMEM = "ppm";
+const FlashDataset CO2_2 PROGMEM = {CO2_2_VALUES, 40, 0, 1800, 64, 255, CO2_2_UNITS};
+
+// pm25_1.csv, 20 readings, ug/m3 0-125 mapped to 64-255
+const uint8_t PM25_1_VALUES[20] PROGMEM = {
+    244, 122, 115, 233, 255, 189, 255, 255, 129, 129, 128, 190, 160, 190, 193, 221, 167, 144, 146, 164};
+const char PM25_1_UNITS[] PROGMEM = "ug/m3";
+const FlashDataset PM25_1 PROGMEM = {PM25_1_VALUES, 20, 0, 125, 64, 255, PM25_1_UNITS};
+
+// pm25_2.csv, 32 readings, ug/m3 0-125 mapped to 64-255
+const uint8_t PM25_2_VALUES[32] PROGMEM = {
+    163, 198, 131, 128, 175, 169, 170, 157, 146, 199, 195, 203, 155, 160, 204, 198, 209, 148, 193, 138,
+    137, 141, 117, 122, 138, 141, 96, 112, 106, 128, 96, 102};
+const char PM25_2_UNITS[] PROGMEM = "ug/m3";
+const FlashDataset PM25_2 PROGMEM = {PM25_2_VALUES, 32, 0, 125, 64, 255, PM25_2_UNITS};
+
+// voc_1.csv, 26 readings, raw 0-130 mapped to 80-255
+const uint8_t VOC_1_VALUES[26] PROGMEM = {
+    90, 94, 86, 97, 101, 98, 100, 102, 100, 106, 119, 108, 109, 105, 98, 97, 105, 113, 102, 100,
+    97, 102, 101, 100, 106, 102};
+const char VOC_1_UNITS[] PROGMEM = "";
+const FlashDataset VOC_1 PROGMEM = {VOC_1_VALUES, 26, 0, 130, 80, 255, VOC_1_UNITS};
+
+// voc_2.csv, 22 readings, raw 0-130 mapped to 80-255
+const uint8_t VOC_2_VALUES[22] PROGMEM = {
+    244, 170, 112, 128, 141, 123, 119, 125, 116, 113, 109, 110, 105, 110, 108, 124, 115, 125, 135, 100,
+    113, 104};
+const char VOC_2_UNITS[] PROGMEM = "";
+const FlashDataset VOC_2 PROGMEM = {VOC_2_VALUES, 22, 0, 130, 80, 255, VOC_2_UNITS};
+
+const FlashDataset *const CO2_CATALOGUE0[1] PROGMEM = {&CO2_1};
+const FlashDataset *const CO2_CATALOGUE1[1] PROGMEM = {&CO2_2};
+const FlashDataset *const PM25_CATALOGUE0[1] PROGMEM = {&PM25_1};
+const FlashDataset *const PM25_CATALOGUE1[1] PROGMEM = {&PM25_2};
+const FlashDataset *const VOC_CATALOGUE0[1] PROGMEM = {&VOC_1};
+const FlashDataset *const VOC_CATALOGUE1[1] PROGMEM = {&VOC_2};
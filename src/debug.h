@@ -0,0 +1,20 @@
+/*--------------------------------------------------------------------------------
+  Debug text on the USB serial port. It shares the port with the frame dump of
+  viewer.h, where text would land inside a frame and fail its crc, so it is dropped
+  while the viewer is on. Replies to the tuning console and uploads still go on
+  Serial, they are asked for. The soak test turns it off for good (isDebugQuiet).
+--------------------------------------------------------------------------------*/
+
+bool isViewing = false;    //frames are going to scripts/led_viewer.py, see viewer.h
+bool isDebugQuiet = false; //no debug text at all, see soak/soak.cpp
+
+class DebugSerial : public Print
+{
+public:
+    size_t write(uint8_t c)
+    {
+        return (isViewing || isDebugQuiet) ? 1 : Serial.write(c);
+    }
+};
+
+DebugSerial debugSerial;
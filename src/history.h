@@ -0,0 +1,143 @@
+/*--------------------------------------------------------------------------------
+  Rolling history of live sensor readings at three resolutions
+    HISTORY_MINUTES : last 60 minutes, one bucket per minute
+    HISTORY_HOURS   : last 24 hours, one bucket per hour
+    HISTORY_DAYS    : last 14 days, one bucket per day
+  Each bucket keeps the min, mean and max of the readings in it. Every reading is
+  added to the open bucket of all three levels, and a bucket is closed into its ring
+  when its period is up, so both are O(1) and RAM is fixed at ~600 bytes.
+
+  A bucket with no readings (sensor unplugged) is kept, so the rings stay aligned with
+  time, and is marked empty by lo > hi.
+--------------------------------------------------------------------------------*/
+
+const uint8_t HISTORY_MINUTES = 0, HISTORY_HOURS = 1, HISTORY_DAYS = 2, HISTORY_LEVELS = 3;
+const uint8_t HISTORY_LEN[HISTORY_LEVELS] = {60, 24, 14};
+const uint8_t HISTORY_FOLD[HISTORY_LEVELS] = {1, 60, 24}; //buckets of the level below per bucket
+const unsigned int HISTORY_BUCKET_MINUTES[HISTORY_LEVELS] = {1, 60, 24 * 60};
+const unsigned long HISTORY_MINUTE_MS = 60000;
+
+struct HistoryBucket
+{
+    int16_t lo, mean, hi;
+};
+
+struct HistoryAccum //bucket still being filled
+{
+    int32_t sum;
+    uint32_t n; //a day of readings at 1Hz is 86400
+    int16_t lo, hi;
+};
+
+HistoryBucket historyMinutes[60], historyHours[24], historyDays[14];
+HistoryBucket *const historyRing[HISTORY_LEVELS] = {historyMinutes, historyHours, historyDays};
+uint8_t historyHead[HISTORY_LEVELS];  //where the next closed bucket goes
+uint8_t historyCount[HISTORY_LEVELS]; //closed buckets so far, up to HISTORY_LEN
+uint8_t historyFolded[HISTORY_LEVELS]; //buckets of the level below since this one opened
+HistoryAccum historyAcc[HISTORY_LEVELS];
+elapsedMillis historyMinutems;
+
+void history_clear_accum(uint8_t level)
+{
+    historyAcc[level].sum = 0;
+    historyAcc[level].n = 0;
+    historyAcc[level].lo = INT16_MAX;
+    historyAcc[level].hi = INT16_MIN;
+}
+
+void history_begin()
+{
+    for (uint8_t level = 0; level < HISTORY_LEVELS; level++)
+    {
+        history_clear_accum(level);
+    }
+    historyMinutems = 0;
+}
+
+/*--------------------------------------------------------------------------------
+  Adds a raw reading to the open bucket of every level
+--------------------------------------------------------------------------------*/
+void history_add(int value)
+{
+    for (uint8_t level = 0; level < HISTORY_LEVELS; level++)
+    {
+        HistoryAccum &acc = historyAcc[level];
+        acc.sum += value;
+        acc.n++;
+        if (value < acc.lo)
+            acc.lo = value;
+        if (value > acc.hi)
+            acc.hi = value;
+    }
+}
+
+void history_close(uint8_t level)
+{
+    HistoryAccum &acc = historyAcc[level];
+    HistoryBucket &bucket = historyRing[level][historyHead[level]];
+
+    bucket.lo = acc.lo; //INT16_MAX > INT16_MIN marks it empty
+    bucket.hi = acc.hi;
+    bucket.mean = (acc.n > 0) ? int16_t(acc.sum / acc.n) : 0;
+
+    historyHead[level] = (historyHead[level] + 1) % HISTORY_LEN[level];
+    if (historyCount[level] < HISTORY_LEN[level])
+    {
+        historyCount[level]++;
+    }
+    history_clear_accum(level);
+}
+
+/*--------------------------------------------------------------------------------
+  Called once per loop(). Closes the minute bucket every minute, and the hour and day
+  buckets when enough of the level below have closed.
+--------------------------------------------------------------------------------*/
+void history_service()
+{
+    if (historyMinutems < HISTORY_MINUTE_MS)
+    {
+        return;
+    }
+    historyMinutems -= HISTORY_MINUTE_MS; //keeps minutes from drifting with loop() timing
+
+    history_close(HISTORY_MINUTES);
+
+    for (uint8_t level = 1; level < HISTORY_LEVELS; level++)
+    {
+        if (++historyFolded[level] < HISTORY_FOLD[level])
+        {
+            break;
+        }
+        historyFolded[level] = 0;
+        history_close(level);
+    }
+}
+
+/*--------------------------------------------------------------------------------
+  Returns the closed bucket age buckets back, 0 being the latest
+--------------------------------------------------------------------------------*/
+const HistoryBucket &history_get(uint8_t level, uint8_t age)
+{
+    return historyRing[level][(historyHead[level] + HISTORY_LEN[level] - 1 - age) % HISTORY_LEN[level]];
+}
+
+bool history_is_empty(const HistoryBucket &bucket)
+{
+    return bucket.lo > bucket.hi;
+}
+
+/*--------------------------------------------------------------------------------
+  Picks the finest level that covers a window of the given number of minutes
+--------------------------------------------------------------------------------*/
+uint8_t history_level_for(unsigned long minutes)
+{
+    if (minutes <= 60UL)
+    {
+        return HISTORY_MINUTES;
+    }
+    if (minutes <= 24UL * 60)
+    {
+        return HISTORY_HOURS;
+    }
+    return HISTORY_DAYS;
+}
@@ -0,0 +1,72 @@
+/*--------------------------------------------------------------------------------
+  Noise idle animation (idleStyle IDLE_NOISE). Brightness drifts slowly along each
+  strip following 2D simplex noise, x along the strip and y in time, with the two
+  strips far apart in x so they do not mirror each other.
+
+  inoise8() costs a few hundred cycles, so it is not run for every pixel every frame.
+  Each pixel's noise level is cached in noiseLevel and NOISE_PIXELS_PER_FRAME of them
+  are refreshed per frame in turn, so the whole pool is refreshed every ~90ms. The
+  noise moves one lattice cell every ~4s, so the steps in between do not show.
+  Drawing a frame is then a cached level and a scale per pixel.
+--------------------------------------------------------------------------------*/
+
+const uint8_t NOISE_PIXELS_PER_FRAME = 16;
+const uint16_t NOISE_SCALE = 40;       //noise x per pixel, ~6 pixels per lattice cell
+const uint16_t NOISE_STRIP2_X = 0x8000; //strip 2 samples a far away part of the noise
+const uint8_t NOISE_MS_SHIFT = 4;      //noise y is sync_millis() / 16
+
+uint8_t noiseLevel[MAX_PIXELS]; //cached brightness per pixel of ledPool
+uint8_t noiseNext = 0;          //next pixel to refresh
+
+/*--------------------------------------------------------------------------------
+  Refreshes the next slice of the cache. Called once per frame while a strip is idle.
+--------------------------------------------------------------------------------*/
+void noise_service()
+{
+    uint8_t numLeds = strip1numLeds + strip2numLeds;
+    uint16_t y = sync_millis() >> NOISE_MS_SHIFT; //in step with the other sculptures
+
+    for (uint8_t n = 0; n < NOISE_PIXELS_PER_FRAME; n++)
+    {
+        if (noiseNext >= numLeds)
+        {
+            noiseNext = 0;
+        }
+
+        uint16_t x = (noiseNext < strip1numLeds) ? noiseNext * NOISE_SCALE : NOISE_STRIP2_X + (noiseNext - strip1numLeds) * NOISE_SCALE;
+        uint8_t level = qsub8(inoise8(x, y), 64); //inoise8 mostly stays within 64 - 192,
+        noiseLevel[noiseNext++] = qadd8(level, level); //stretch that to 0 - 255
+    }
+}
+
+/*--------------------------------------------------------------------------------
+  Draws cached noise levels over a strip in its colour, peaking at brightness
+--------------------------------------------------------------------------------*/
+void noise_fill(CRGB *leds, int numLeds, const uint8_t *levels, CHSV color, uint8_t brightness)
+{
+    color.val = brightness;
+    CRGB base = blend_prescale(color); //one hsv conversion per strip
+
+    for (int i = 0; i < numLeds; i++)
+    {
+        CRGB pixel = base;
+        pixel.nscale8_video(levels[i]);
+        blend_scaled_pixel(leds[i], pixel);
+    }
+}
+
+/*--------------------------------------------------------------------------------
+  Brightness ramps up once from 0 after playback, then holds at the max, which live
+  mode can lower
+--------------------------------------------------------------------------------*/
+void strip1_noise_animation()
+{
+    strip1brightness = min(strip1brightness + 1, strip1maxBrightLvl);
+    noise_fill(strip1leds, strip1numLeds, noiseLevel, strip1Color, strip1brightness);
+}
+
+void strip2_noise_animation()
+{
+    strip2brightness = min(strip2brightness + 1, strip2maxBrightLvl);
+    noise_fill(strip2leds, strip2numLeds, noiseLevel + strip1numLeds, strip2Color, strip2brightness);
+}
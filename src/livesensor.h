@@ -0,0 +1,166 @@
+/*--------------------------------------------------------------------------------
+  Live air quality mode. A sensor on Serial1 (TX1 18, RX1 19) streams readings and,
+  while they keep coming, the idle pulse of both strips peaks at the brightness of the
+  latest reading, mapped the same way as the sculpture's built in data set. A button
+  still plays back the archived readings on its strip.
+
+  Supported sensors, picked by the sculpture profile
+    SENSOR_MHZ19  : CO2. Polled with a read command, answers
+                    FF 86 HI LO xx xx xx xx CS, CS = 0 - sum of bytes 1..7
+    SENSOR_SDS011 : PM2.5. Sends on its own once a second
+                    AA C0 PM25LO PM25HI PM10LO PM10HI ID ID CS AB, CS = sum of the 6 data bytes
+                    PM2.5 is in tenths of ug/m3
+
+  The parser is a byte at a time state machine with a fixed frame buffer. It never
+  waits for the rest of a frame and takes at most LIVE_BYTES_PER_FRAME per loop().
+
+  scripts/fake_air_sensor.py stands in for either sensor, with bad checksums and
+  broken frames to resync on.
+--------------------------------------------------------------------------------*/
+
+const uint8_t LIVE_FRAME_MAX = 10;
+const uint8_t LIVE_BYTES_PER_FRAME = 16;
+const unsigned int LIVE_POLL_INTERVAL = 2000; //ms between MH-Z19 read commands
+const unsigned int LIVE_TIMEOUT = 10000;      //ms without a reading before live mode ends
+
+const uint8_t MHZ19_READ_CMD[9] = {0xFF, 0x01, 0x86, 0x00, 0x00, 0x00, 0x00, 0x00, 0x79};
+
+uint8_t liveFrame[LIVE_FRAME_MAX];
+uint8_t liveFramePos = 0;
+int liveReading;            //latest reading in the sensor's units
+uint8_t liveBrightness;     //latest reading mapped to brightness
+bool isLiveMode = false;    //true while readings are fresh
+elapsedMillis liveReadingms, livePollms;
+FlashDataset liveScale;     //raw and brightness range of the sculpture's data
+
+/*--------------------------------------------------------------------------------
+  Done once during setup()
+--------------------------------------------------------------------------------*/
+void live_begin()
+{
+    if (profile.liveSensor == SENSOR_NONE)
+    {
+        return;
+    }
+
+    Serial1.begin(9600); //both sensors talk at 9600 8N1
+    memcpy_P(&liveScale, pgm_read_ptr(&profile.catalogue[0][0]), sizeof(FlashDataset));
+    history_begin();
+}
+
+/*--------------------------------------------------------------------------------
+  Feeds one byte to the parser. Returns true when it completes a valid frame, with the
+  reading in liveReading. A bad byte restarts the search for a frame header.
+--------------------------------------------------------------------------------*/
+bool live_parse_byte(uint8_t sensor, uint8_t c)
+{
+    if (sensor == SENSOR_MHZ19)
+    {
+        if (liveFramePos == 1 && c != 0x86)
+        {
+            liveFramePos = 0; //c may still be the start of the next frame
+        }
+        if (liveFramePos == 0 && c != 0xFF)
+        {
+            return false;
+        }
+        liveFrame[liveFramePos++] = c;
+
+        if (liveFramePos == 9)
+        {
+            liveFramePos = 0;
+            uint8_t sum = 0;
+            for (uint8_t i = 1; i < 8; i++)
+            {
+                sum += liveFrame[i];
+            }
+            if (uint8_t(0 - sum) == liveFrame[8])
+            {
+                liveReading = (liveFrame[2] << 8) | liveFrame[3];
+                return true;
+            }
+        }
+    }
+    else if (sensor == SENSOR_SDS011)
+    {
+        if (liveFramePos == 1 && c != 0xC0)
+        {
+            liveFramePos = 0; //c may still be the start of the next frame
+        }
+        if (liveFramePos == 0 && c != 0xAA)
+        {
+            return false;
+        }
+        liveFrame[liveFramePos++] = c;
+
+        if (liveFramePos == 10)
+        {
+            liveFramePos = 0;
+            uint8_t sum = 0;
+            for (uint8_t i = 2; i < 8; i++)
+            {
+                sum += liveFrame[i];
+            }
+            if (sum == liveFrame[8] && liveFrame[9] == 0xAB)
+            {
+                liveReading = ((liveFrame[3] << 8) | liveFrame[2]) / 10;
+                return true;
+            }
+        }
+    }
+    return false;
+}
+
+/*--------------------------------------------------------------------------------
+  Called once per loop(). Polls the sensor if it needs it, parses what has arrived and
+  caps the idle pulse of idle strips at the live brightness.
+--------------------------------------------------------------------------------*/
+void live_service()
+{
+    if (profile.liveSensor == SENSOR_NONE)
+    {
+        return;
+    }
+
+    if (profile.liveSensor == SENSOR_MHZ19 && livePollms > LIVE_POLL_INTERVAL)
+    {
+        Serial1.write(MHZ19_READ_CMD, sizeof(MHZ19_READ_CMD)); //fits in the TX buffer, does not block
+        livePollms = 0;
+    }
+
+    for (uint8_t n = 0; n < LIVE_BYTES_PER_FRAME && Serial1.available() > 0; n++)
+    {
+        if (live_parse_byte(profile.liveSensor, Serial1.read()))
+        {
+            liveBrightness = constrain(map(liveReading, liveScale.inMin, liveScale.inMax, liveScale.outMin, liveScale.outMax), 0, 255);
+            liveReadingms = 0;
+            history_add(liveReading);
+            if (!isLiveMode)
+            {
+                isLiveMode = true;
+                debugSerial.println("live mode on");
+            }
+        }
+    }
+
+    history_service();
+
+    if (isLiveMode && liveReadingms > LIVE_TIMEOUT)
+    {
+        isLiveMode = false;
+        strip1maxBrightLvl = strip2maxBrightLvl = 255;
+        debugSerial.println("live mode off");
+    }
+
+    if (isLiveMode)
+    {
+        if (strip1playMode == IDLE_MODE)
+        {
+            strip1maxBrightLvl = liveBrightness;
+        }
+        if (strip2playMode == IDLE_MODE)
+        {
+            strip2maxBrightLvl = liveBrightness;
+        }
+    }
+}
@@ -3,7 +3,7 @@
   Date: Nov 2019
   Description: Air sculptures 1, 2 and 3 - CO2, PM25 and VOC
 
-      This version uses the Arduino Mega 2560. No audio functionality (yet). A 3.3V teensy is unable to drive a long 24V led strip, and thus a 5V microcontroller and signal is needed for the data line.
+      This version uses the Arduino Mega 2560, with sound from a serial MP3 module. A 3.3V teensy is unable to drive a long 24V led strip, and thus a 5V microcontroller and signal is needed for the data line.
 
       Each sculpture has two buttons and one distance sensor each.
       The two buttons play back the two sets of air measurements readings translated into brightness values. 
@@ -11,7 +11,7 @@
       There is an idle mode pulsing light animation. Active mode is triggered by button and will show a sequence of brightness values. 
       The distance sensor changes the hue of the leds in real time. 
       There is a sound for idle mode and one for active playback mode. 
-      Sound disabled for the Arduino since it does not have an audio shield (yet).
+      The Arduino has no audio shield, so the sounds are played by a DFPlayer style MP3 module, see audio.h.
 */
 
 #include <Arduino.h>
@@ -19,13 +19,22 @@
 #include <FastLED.h>
 #include <elapsedMillis.h>
 #include <Adafruit_VL53L0X.h>
+#include <EEPROM.h>
+#include <SPI.h>
+#include <Wire.h>
 
 //-------------------- USER DEFINED SETTINGS --------------------//
 
-//Uncomment one below
-// #define __CO2__
-// #define __PM25__ 
-#define __VOC__
+//Sculpture type is read from EEPROM at boot, so the same firmware runs on all three sculptures.
+//To change it, send '1' (CO2), '2' (PM25) or '3' (VOC) over serial during the power up delay.
+const uint8_t CO2_ID = 1, PM25_ID = 2, VOC_ID = 3;
+const uint8_t DEFAULT_SCULPTURE_ID = VOC_ID; //used when no valid ID has been saved
+const int EEPROM_CONFIG_ADDR = 0x040, EEPROM_CONFIG_SIZE = 0xC0; //sculpture ID and tuning parameters, see config.h
+const int EEPROM_PROGRAM_ADDR = 0x100, EEPROM_PROGRAM_SIZE = 256; //animation program uploaded over serial
+const int EEPROM_CUES_ADDR = 0x200, EEPROM_CUES_SIZE = 256; //show schedule, see scheduler.h
+const int EEPROM_ANALYTICS_ADDR = 0x300; //visitor counters, 212 bytes, see analytics.h
+const int EEPROM_DATASET_ADDR = 1024, EEPROM_DATASET_SIZE = 1024; //one slot per button for data sets uploaded over serial
+const int EEPROM_RECORDER_ADDR = 0xC00; //black box log saved from the tuning console, see recorder.h
 
 //PINOUTS for LED strips
 const int CO2STRIP1_1PIN = 7, CO2STRIP1_2PIN = 6, CO2STRIP1_3PIN = 5, CO2STRIP2PIN = 4;//for CO2
@@ -37,21 +46,39 @@ const int button0pin = 14, button1pin = 15;
 //PINOUTS for dist sensor
 //SCL to 21 and SDA to 20
 
+//PINOUTS for optional live air quality sensor (MH-Z19 for CO2, SDS011 for PM25)
+//sensor TX to RX1 19, sensor RX to TX1 18
+
+//PINOUTS for optional SPI flash with long data sets
+//MISO to 50, MOSI to 51, SCK to 52
+const int SPIFLASH_CS_PIN = 53;
+const uint32_t SPIFLASH_SLOT_SIZE = 0x10000; //one slot per button at the start of the chip
+
+//PINOUTS for optional sync bus between the sculptures, see sync.h
+//TX2 16 to DI, RX2 17 to RO of an RS-485 transceiver
+const int SYNC_DE_PIN = 22; //driver enable (DE and /RE tied together)
+const uint8_t SYNC_MASTER_ID = CO2_ID; //sculpture that sends the clock
+bool isSyncMirror = false; //true: a button pressed on one sculpture plays on all of them
+
+//PINOUTS for optional MP3 module, see audio.h
+//module TX to 10, module RX to 11 through 1k
+
 CHSV activeColor(140,255,255); //light blue
 CHSV idleColor(140,128,255); //half the saturation
 
 const int CO2band1_1 = 25, CO2band1_2 = 25, CO2band1_3 = 25, CO2band2 = 55, PM25band1 = 55, PM25band2 = 55, VOCband1 = 40, VOCband2 = 40; //num of pixels per strip. Each pixel is 10cm.
 
-const int CO2_1[17] = { 1609, 577, 406, 419, 443, 414, 403, 413, 409, 411, 412, 409, 423, 414, 421, 434, 421 };
-const int CO2_2[40] = { 1685, 642, 618, 698, 697, 778, 450, 664, 648, 676, 425, 504, 550, 481, 640, 942, 1791, 504, 733, 688, 592, 608, 850, 779, 1876, 646, 648, 659, 893, 422, 455, 701, 716, 892, 1046, 455, 483, 503, 448, 550 };
-
-const int PM25_1[20] = { 118, 38, 34, 111, 125, 82, 178, 174, 43, 43, 42, 83, 63, 83, 85, 103, 68, 53, 54, 66 };
-const int PM25_2[32] = { 65, 88, 44, 42, 73, 69, 70, 61, 54, 89, 86, 91, 60, 63, 92, 88, 95, 55, 85, 49, 48, 51, 35, 38, 49, 51, 21, 32, 28, 42, 21, 25 };
-
-const int VOC_1[26] = { 8, 11, 5, 13, 16, 14, 15, 17, 15, 20, 29, 21, 22, 19, 14, 13, 19, 25, 17, 15, 13, 17, 16, 15, 20, 17 };
-const int VOC_2[22] = { 122, 67, 24, 36, 46, 32, 29, 34, 27, 25, 22, 23, 19, 23, 21, 33, 26, 34, 41, 15, 25, 18 };
+//Data sets live in datasets/*.csv and are compiled into flash tables of brightness values by scripts/gen_datasets.py
 
 const int BAND_DELAY = 500;   //controls led animation speed
+uint16_t bandDelay = BAND_DELAY; //the tuning console can change it
+const uint8_t IDLE_PULSE = 0, IDLE_NOISE = 1;
+uint8_t idleStyle = IDLE_PULSE; //idle animation: whole strip fading up and down, or brightness drifting along it
+const uint8_t PLAYBACK_FILL = 0, PLAYBACK_WAVES = 1, PLAYBACK_PROGRAM = 2;
+uint8_t playbackStyle = PLAYBACK_FILL; //playback: whole strip at the reading, a pulse travelling along it per reading, or an animation program
+uint8_t playbackProgram = 0; //built in animation program, programs/*.anim in file name order
+bool isLinkedPlayback = false; //true: either button plays both data sets side by side on one clock, stretched to the same length
+const int PLAYBACK_MS_NEAR = 4000, PLAYBACK_MS_FAR = 150; //ms per reading with a visitor up close and at 1m. bandDelay * 2 when nobody is there.
 
 //-------------------- Buttons and distance sensor --------------------//
 Bounce button0 = Bounce(button0pin, 15); // 15 = 15 ms debounce time
@@ -63,6 +90,8 @@ Adafruit_VL53L0X lox = Adafruit_VL53L0X(); //SCL to 21 and SDA to 20
 int rangeVal; //reading in mm
 elapsedMillis loxmsec; //to track that it takes measurement at an interval of around 100ms instead of continuously
 bool isUserPresent = false;
+uint16_t presenceRange = 1000; //mm, anyone further away is not counted as a visitor
+bool (*inputOverride)() = NULL; //when set, read_console() calls it instead of reading the buttons and dist sensor, true on a new reading (see soak/soak.cpp)
 
 //-------------------- Light --------------------//
 
@@ -72,26 +101,19 @@ bool isUserPresent = false;
 CHSV strip1Color = idleColor;
 CHSV strip2Color = idleColor;
 
-#if defined(__CO2__)
-const int SCULPTURE_ID = 1;
-int readings1[17], readings2[40];
-CRGB leds0[CO2band1_1]; CRGB leds1[CO2band1_2]; CRGB leds2[CO2band1_3]; CRGB leds3[CO2band2];
-
-#elif defined(__PM25__)
-const int SCULPTURE_ID = 2;
-int readings1[20], readings2[32];
-CRGB leds0[PM25band1]; CRGB leds1[PM25band2]; CRGB leds2[0]; CRGB leds3[0];
+const int MAX_PIXELS = CO2band1_1 + CO2band1_2 + CO2band1_3 + CO2band2; //largest sculpture
 
-#elif defined(__VOC__)
-const int SCULPTURE_ID = 3;
-int readings1[26], readings2[22];
-CRGB leds0[VOCband1]; CRGB leds1[VOCband2]; CRGB leds2[0]; CRGB leds3[0];
+uint8_t SCULPTURE_ID; //set from EEPROM at boot
 
-#else
-#error "invalid sculpture ID"
-#endif
+//All strips share one pixel pool. Strip 1 always comes first and is contiguous even when it is split over
+//several data pins (top ring of CO2), so the animations only ever fill two plain arrays.
+CRGB ledPool[MAX_PIXELS];
+CRGB *strip1leds = ledPool, *strip2leds;
+int strip1numLeds, strip2numLeds;
+CRGB *leds0, *leds1, *leds2, *leds3; //one per data pin, NULL if unused by the sculpture
 
 #define UPDATES_PER_SECOND 100 //speed of light animation
+uint8_t framesPerSecond = UPDATES_PER_SECOND; //the show schedule can lower it
 const int IDLE_MODE = 1, BUTTON_MODE = 2;
 unsigned int strip1playMode = IDLE_MODE, strip2playMode = IDLE_MODE; 
 
@@ -99,13 +121,41 @@ int strip1brightness = 0, strip2brightness = 0; //band brightness
 int strip1maxBrightLvl = 255, strip2maxBrightLvl = 255; //variable max brightness
 bool strip1hasPlayModeChanged = false, strip2hasPlayModeChanged = false; //for audio track changes
 int strip1activeLedState = 0, strip2activeLedState = 0;            //to track led animaton states, e.g. 0 - idle mode, start fade to black 1 - show brightness according to reading, 2 - has completed animations, fade to black and idle
-bool strip1isMaxBrightness = false, strip2isMaxBrightness = false;      //to track idle animation direction
 elapsedMillis strip1bandms, strip2bandms;              //multiple use time ellapsed counter
-unsigned int strip1bandDelay = BAND_DELAY, strip2bandDelay = BAND_DELAY; //speed of fade animation
 unsigned int strip1readingsCounter, strip2readingsCounter;                 //keeps track of indexing the readings array
 unsigned int strip1prevBrightVal, strip1currBrightVal, strip2prevBrightVal, strip2currBrightVal;    //for comparing prev and current values for dimming and brightening
 
+const uint32_t PLAYBACK_STEP = 65536; //playback phase per reading
+const uint8_t FADE_GAIN_NEAR = 16, FADE_GAIN_NORMAL = 64, FADE_GAIN_FAR = 128; //x16, how much faster than the reading the crossfade to it runs
+uint16_t playbackRate, playbackTargetRate; //phase per ms, set by the dist sensor
+uint8_t playbackFadeGain, playbackTargetFadeGain;
+uint32_t strip1phase, strip2phase; //how far into the current reading, 0 - PLAYBACK_STEP
+
+#include "debug.h" //debug text, quiet while the viewer is on
+#include "crc8.h" //for the serial protocols
+#include "config.h" //settings kept over a reset
+#include "datasets_generated.h" //built from datasets/*.csv before every build
+#include "palettes_generated.h" //256 entry colour palettes, built before every build
+#include "programs_generated.h" //animation programs, assembled from programs/*.anim before every build
+#include "blend.h" //blend modes for the compositor layers
+#include "profiles.h" //per sculpture pinouts, data sets and function table
+#include "spiflash.h" //external flash for long data sets
+#include "history.h" //minute, hour and day history of live readings
+#include "livesensor.h" //live readings from a UART air quality sensor
+#include "dataset.h" //playback data sources
+#include "waves.h" //travelling wave playback
+#include "animvm.h" //animation program interpreter
+#include "recorder.h" //black box log of inputs and mode changes
+#include "sync.h" //shared clock and buttons between sculptures
+#include "analytics.h" //visitor counters
 #include "myfunctions.h" //supporting functions
+#include "idlenoise.h" //noise idle animation
+#include "compositor.h" //render layers
+#include "scheduler.h" //time of day show schedule
+#include "audio.h" //sound cues on an MP3 module
+#include "viewer.h" //frame dump for scripts/led_viewer.py
+#include "console.h" //parameter tuning over serial
+#include "upload.h" //data set upload over serial
 
 //-------------------- Setup --------------------//
 
@@ -119,63 +169,73 @@ void setup() {
   Serial.println("Adafruit VL53L0X test");
   if (!lox.begin()) {
     Serial.println(F("Failed to boot VL53L0X"));
-    while(1);
+    while(inputOverride == NULL); //nothing to do without it, unless the inputs come from elsewhere
   }
 
   delay(2000); //power up safety delay
 
-  if (SCULPTURE_ID == 1) //top ring of CO2 sculpture split into 3 strips
-  {
-    FastLED.addLeds<LED_TYPE, CO2STRIP1_1PIN, COLOR_ORDER>(leds0, CO2band1_1);
-    FastLED.addLeds<LED_TYPE, CO2STRIP1_2PIN, COLOR_ORDER>(leds1, CO2band1_2);
-    FastLED.addLeds<LED_TYPE, CO2STRIP1_3PIN, COLOR_ORDER>(leds2, CO2band1_3);
-    FastLED.addLeds<LED_TYPE, CO2STRIP2PIN, COLOR_ORDER>(leds3, CO2band2);
-  } 
-  else if (SCULPTURE_ID == 2)
-  {
-    FastLED.addLeds<LED_TYPE, STRIP1PIN, COLOR_ORDER>(leds0, PM25band1);
-    FastLED.addLeds<LED_TYPE, STRIP2PIN, COLOR_ORDER>(leds1, PM25band2); 
-  }
-  else if (SCULPTURE_ID == 3)
-  {
-    FastLED.addLeds<LED_TYPE, STRIP1PIN, COLOR_ORDER>(leds0, VOCband1);
-    FastLED.addLeds<LED_TYPE, STRIP2PIN, COLOR_ORDER>(leds1, VOCband2); 
-  }
-  FastLED.setBrightness(255);
+  config_begin(); //newest saved settings
 
-  delay(10);
+  load_profile(); //pick CO2, PM25 or VOC from EEPROM (or serial override)
+
+  params_load(); //values saved from the tuning console
+
+  spiflash_begin();
+
+  live_begin();
+
+  schedule_begin();
+
+  analytics_begin();
+
+  sync_begin();
+
+  audio_begin();
 
-  register_readings(); //translate the air measurement data points into a readings[] brightness value array
+  profile.add_leds(); //brightness is set by the show schedule
+
+  delay(10);
 }
 
 void loop() {
+  view_frame_begin();//frame time for the viewer
+
+  console_service();//runs a tuning console line between frames
+
+  config_service();//saves settings, a byte per frame
+
+  rec_service();//saves the black box log when asked, a byte per frame
+
   read_console();//gets input from dist sensor and buttons
 
+  update_playback_speed();//eases playback speed towards the one set by the dist sensor
+
+  update_linked_clock();//shared clock for both strips in linked playback
+
+  sync_service();//clock beacons and mirrored buttons between sculptures
+
+  upload_service();//data set upload over serial, a few bytes per frame
+
+  dataset_service(strip1data);//prefetch from SPI flash so playback never waits on it
+  dataset_service(strip2data);
+
+  live_service();//live sensor readings set the idle pulse brightness
+
+  schedule_service();//show mode, brightness cap and frame rate by time of day
+
+  analytics_service(schedule_hour(), isClockSet);//visits, presses and playbacks per hour
+
   do_colour_variation();//changes hue of both strips according to dist sensor
 
   set_playMode();
 
-  if (strip1playMode == IDLE_MODE)
-  {
-    strip1_idle_animation();
-  }
-  else if (strip1playMode == BUTTON_MODE)
-  {
-    strip1_playback_readings(); //play brightness sequence according to readings[] array
-  }
+  render_layers();//idle pulse, data playback, sparkle and presence glow, see compositor.h
 
-  if (strip2playMode == IDLE_MODE)
-  {
-    strip2_idle_animation();
-  } 
-  else if (strip2playMode == BUTTON_MODE)
-  {
-    strip2_playback_readings(); //play brightness sequence according to readings[] array
-  }
+  audio_service();//sound cues for play mode changes, a byte per frame
 
-  add_glitter();
+  view_service();//the frame to scripts/led_viewer.py, when asked
 
   FastLED.show();
-  FastLED.delay(1000 / UPDATES_PER_SECOND);
+  FastLED.delay(1000 / framesPerSecond);
 }
 
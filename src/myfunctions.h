@@ -1,8 +1,160 @@
+/*--------------------------------------------------------------------------------
+  Playback speed and zoom. Step close and playback slows down and zooms in, every
+  reading becomes one long crossfade from the last. Step back and it fast forwards
+  with short crossfades. set_playback_speed() runs on each dist sensor reading (~10Hz)
+  and is the only part that divides. Each frame the speed eases towards its target,
+  so the time base never jumps, and the phase is advanced with one multiply.
+--------------------------------------------------------------------------------*/
+void set_playback_speed()
+{
+    unsigned int msPerReading = bandDelay * 2;
+    playbackTargetFadeGain = FADE_GAIN_NORMAL;
+
+    if (isUserPresent == true)
+    {
+        msPerReading = map(rangeVal, 0, presenceRange, PLAYBACK_MS_NEAR, PLAYBACK_MS_FAR);
+        playbackTargetFadeGain = map(rangeVal, 0, presenceRange, FADE_GAIN_NEAR, FADE_GAIN_FAR);
+    }
+    playbackTargetRate = PLAYBACK_STEP / msPerReading;
+}
+
+void update_playback_speed()
+{
+    if (playbackRate == 0) //first frame
+    {
+        set_playback_speed();
+        playbackRate = playbackTargetRate;
+        playbackFadeGain = playbackTargetFadeGain;
+    }
+    playbackRate += (int(playbackTargetRate) - int(playbackRate)) >> 3;
+    playbackFadeGain += (int(playbackTargetFadeGain) - int(playbackFadeGain)) >> 3;
+}
+
+/*--------------------------------------------------------------------------------
+  Moves a strip's playback phase on by the time since its last frame. Returns true
+  when it has passed the end of the current reading.
+--------------------------------------------------------------------------------*/
+bool advance_phase(uint32_t &phase, elapsedMillis &bandms)
+{
+    unsigned int dt = bandms;
+    bandms -= dt; //keeps the leftover fraction of a ms
+
+    phase += uint32_t(playbackRate) * dt;
+
+    if (phase >= PLAYBACK_STEP)
+    {
+        phase -= PLAYBACK_STEP;
+        if (phase >= PLAYBACK_STEP) //stalled for more than a reading, don't skip any
+        {
+            phase = 0;
+        }
+        return true;
+    }
+    return false;
+}
+
+/*--------------------------------------------------------------------------------
+  How far the crossfade from the previous to the current reading has got, 0 - 255
+--------------------------------------------------------------------------------*/
+uint8_t crossfade_amount(uint32_t phase)
+{
+    uint16_t amount = (uint16_t(phase >> 8) * playbackFadeGain) >> 4;
+    return (amount > 255) ? 255 : amount;
+}
+
+/*--------------------------------------------------------------------------------
+  Linked playback. Both strips run off one clock, advanced once per frame, and each
+  strip's phase moves by that clock times len / longest len, so both data sets start
+  and finish together even though their lengths differ. The scales are worked out once
+  when playback starts. The remainder of each scaling is carried over so the strips
+  never drift apart.
+--------------------------------------------------------------------------------*/
+elapsedMillis linkedms;
+uint16_t linkedDelta;      //phase of the longest data set to add this frame
+uint32_t linkedScale[2];   //len / longest len, x65536
+uint16_t linkedRemainder[2];
+bool isLinkedClockRunning = false;
+
+void update_linked_clock()
+{
+    linkedDelta = 0;
+
+    if (!isLinkedPlayback)
+    {
+        return;
+    }
+
+    if (strip1activeLedState == 1 && strip2activeLedState == 1)
+    {
+        if (!isLinkedClockRunning) //both strips have just opened their data sets
+        {
+            unsigned int longest = max(strip1data.len, strip2data.len);
+            linkedScale[0] = (uint32_t(strip1data.len) << 16) / longest;
+            linkedScale[1] = (uint32_t(strip2data.len) << 16) / longest;
+            linkedRemainder[0] = linkedRemainder[1] = 0;
+            linkedms = 0;
+            isLinkedClockRunning = true;
+        }
+        else
+        {
+            unsigned int dt = linkedms;
+            linkedms -= dt;
+            linkedDelta = min(uint32_t(playbackRate) * dt, uint32_t(PLAYBACK_STEP - 1));
+        }
+    }
+    else
+    {
+        if (strip1activeLedState == 2 && strip2activeLedState == 1) //end together, whatever the rounding
+        {
+            strip2activeLedState = 2;
+        }
+        else if (strip2activeLedState == 2 && strip1activeLedState == 1)
+        {
+            strip1activeLedState = 2;
+        }
+        isLinkedClockRunning = false;
+    }
+}
+
+bool advance_linked_phase(uint32_t &phase, uint8_t strip)
+{
+    uint32_t scaled = uint32_t(linkedDelta) * linkedScale[strip] + linkedRemainder[strip];
+    linkedRemainder[strip] = scaled & 0xFFFF;
+    phase += scaled >> 16;
+
+    if (phase >= PLAYBACK_STEP)
+    {
+        phase -= PLAYBACK_STEP;
+        return true;
+    }
+    return false;
+}
+
 /*--------------------------------------------------------------------------------
   Reads the two buttons and distance sensor. Dist sensor changes hue of both led strips.
 --------------------------------------------------------------------------------*/
 void read_console()
 {
+    if (isReplaying) //inputs come from the recorder's log instead, see recorder.h
+    {
+        replay_read_inputs();
+        if (isReplayRangeDue)
+        {
+            isReplayRangeDue = false;
+            set_playback_speed();
+        }
+        return;
+    }
+
+    if (inputOverride != NULL)
+    {
+        if (inputOverride())
+        {
+            set_playback_speed();
+        }
+        return;
+    }
+
     if (strip1playMode == IDLE_MODE)
     {
         button0.update(); //let animation finish before listening again, cos kids mashing buttons.
@@ -10,7 +162,10 @@ void read_console()
         if (button0.fallingEdge())
         {
             isButton0Pressed = true;
-            Serial.println("button0 pressed");
+            debugSerial.println("button0 pressed");
+            sync_send_button(0);
+            analytics_on_press(0);
+            rec_log_button(0);
         }
     }
     if (strip2playMode == IDLE_MODE)
@@ -20,7 +175,10 @@ void read_console()
         if (button1.fallingEdge())
         {
             isButton1Pressed = true;
-            Serial.println("button1 pressed");
+            debugSerial.println("button1 pressed");
+            sync_send_button(1);
+            analytics_on_press(1);
+            rec_log_button(1);
         }
     }
 
@@ -35,7 +193,7 @@ void read_console()
         { // phase failures have incorrect data
             rangeVal = measure.RangeMilliMeter;
 
-            if (rangeVal > 1000)
+            if (rangeVal > presenceRange)
             {
                 isUserPresent = false;
             }
@@ -50,6 +208,9 @@ void read_console()
             // Serial.println(" out of range ");
             isUserPresent = false;
         }
+        rec_log_range(measure.RangeStatus != 4);
+
+        set_playback_speed();
 
         loxmsec = 0; //refresh timer for next reading
     }
@@ -87,59 +248,25 @@ void do_colour_variation()
 }
 
 /*--------------------------------------------------------------------------------
-  Done once during setup(). Translates the raw data readings into brightness values.
+  Toggles the playMode according to button press
 --------------------------------------------------------------------------------*/
-void register_readings()
+void set_playMode()
 {
-    if (SCULPTURE_ID == 1)
+    if (isLinkedPlayback && (isButton0Pressed || isButton1Pressed)) //one button starts both
     {
-        for (int i = 0; i < 17; i++)
-        {
-            readings1[i] = int(map(CO2_1[i], 0, 1800, 64, 255));
-        }
-        for (int i = 0; i < 40; i++)
-        {
-            readings2[i] = int(map(CO2_2[i], 0, 1800, 64, 255));
-        }
-    }
-    else if (SCULPTURE_ID == 2)
-    {
-        for (int i = 0; i < 20; i++)
-        {
-            readings1[i] = int(map(PM25_1[i], 0, 125, 64, 255));
-        }
-        for (int i = 0; i < 32; i++)
-        {
-            readings2[i] = int(map(PM25_2[i], 0, 125, 64, 255));
-        }
+        isButton0Pressed = isButton1Pressed = true;
     }
-    else //sculpture 3
-    {
-        for (int i = 0; i < 26; i++)
-        {
-            readings1[i] = int(map(VOC_1[i], 0, 130, 80, 255));
-        }
-        for (int i = 0; i < 22; i++)
-        {
-            readings2[i] = int(map(VOC_2[i], 0, 130, 80, 255));
-        }
-    }
-}
 
-/*--------------------------------------------------------------------------------
-  Toggles the playMode according to button press
---------------------------------------------------------------------------------*/
-void set_playMode()
-{
     if (isButton0Pressed == true) //process button press
     {
         isButton0Pressed = false; //listen again for button presses
         strip1playMode = BUTTON_MODE;
         strip1hasPlayModeChanged = true; //trigger sound change
-        Serial.println("strip1 : BUTTON MODE");
+        debugSerial.println("strip1 : BUTTON MODE");
+        analytics_on_playback_start(0);
+        rec_log_mode(0, BUTTON_MODE);
 
         strip1activeLedState = 0;         //reset the led if currently active
-        strip1bandDelay = BAND_DELAY / 4; //speed up the fade animation
         strip1Color = activeColor;
     }
 
@@ -148,10 +275,11 @@ void set_playMode()
         isButton1Pressed = false; //listen again for button presses
         strip2playMode = BUTTON_MODE;
         strip2hasPlayModeChanged = true; //trigger sound change
-        Serial.println("strip2 : BUTTON MODE");
+        debugSerial.println("strip2 : BUTTON MODE");
+        analytics_on_playback_start(1);
+        rec_log_mode(1, BUTTON_MODE);
 
         strip2activeLedState = 0;         //reset the led if currently active
-        strip2bandDelay = BAND_DELAY / 4; //speed up the fade animation
         strip2Color = activeColor;
     }
 }
@@ -161,282 +289,82 @@ void set_playMode()
 --------------------------------------------------------------------------------*/
 void strip1_fade()
 {
-    if (SCULPTURE_ID == 1)
-    {
-        for (int i = 0; i < CO2band1_1; i++)
-        {
-            leds0[i].fadeToBlackBy(8);
-        }
-        for (int i = 0; i < CO2band1_2; i++)
-        {
-            leds1[i].fadeToBlackBy(8);
-        }
-        for (int i = 0; i < CO2band1_3; i++)
-        {
-            leds2[i].fadeToBlackBy(8);
-        }
-    }
-    else if (SCULPTURE_ID == 2)
-    {
-        for (int i = 0; i < PM25band1; i++)
-        {
-            leds0[i].fadeToBlackBy(8);
-        }
-    }
-    else if (SCULPTURE_ID == 3)
-    {
-        for (int i = 0; i < VOCband1; i++)
-        {
-            leds0[i].fadeToBlackBy(8);
-        }
-    }
+    fadeToBlackBy(strip1leds, strip1numLeds, 8);
 }
 
 void strip2_fade()
 {
-    if (SCULPTURE_ID == 1)
-    {
-        for (int i = 0; i < CO2band2; i++)
-        {
-            leds3[i].fadeToBlackBy(8);
-        }
-    }
-    else if (SCULPTURE_ID == 2)
-    {
-        for (int i = 0; i < PM25band2; i++)
-        {
-            leds1[i].fadeToBlackBy(8);
-        }
-    }
-    else if (SCULPTURE_ID == 3)
-    {
-        for (int i = 0; i < VOCband2; i++)
-        {
-            leds1[i].fadeToBlackBy(8);
-        }
-    }
+    fadeToBlackBy(strip2leds, strip2numLeds, 8);
 }
 
-void strip1_set_brightLevel(int brightlvl)
+void strip1_set_brightLevel(int brightlvl) //palette colour of the level, dimmed to it
 {
-    strip1Color.val = brightlvl;
+    CRGB colour = palette_colour(brightlvl);
 
-    if (SCULPTURE_ID == 1)
-    {
-        for (int i = 0; i < CO2band1_1; i++)
-        {
-            leds0[i] = strip1Color;
-        }
-        for (int i = 0; i < CO2band1_2; i++)
-        {
-            leds1[i] = strip1Color;
-        }
-        for (int i = 0; i < CO2band1_3; i++)
-        {
-            leds2[i] = strip1Color;
-        }
-    }
-    else if (SCULPTURE_ID == 2)
-    {
-        for (int i = 0; i < PM25band1; i++)
-        {
-            leds0[i] = strip1Color;
-        }
-    }
-    else if (SCULPTURE_ID == 3)
-    {
-        for (int i = 0; i < VOCband1; i++)
-        {
-            leds0[i] = strip1Color;
-        }
-    }
+    strip1Color.val = brightlvl;
+    colour.nscale8_video(brightlvl);
+    blend_fill(strip1leds, strip1numLeds, colour);
 }
 
-void strip2_set_brightLevel(int brightlvl)
+void strip2_set_brightLevel(int brightlvl) //palette colour of the level, dimmed to it
 {
-    strip2Color.val = brightlvl;
+    CRGB colour = palette_colour(brightlvl);
 
-    if (SCULPTURE_ID == 1)
-    {
-        for (int i = 0; i < CO2band2; i++)
-        {
-            leds3[i] = strip2Color;
-        }
-    }
-    else if (SCULPTURE_ID == 2)
-    {
-        for (int i = 0; i < PM25band2; i++)
-        {
-            leds1[i] = strip2Color;
-        }
-    }
-    else if (SCULPTURE_ID == 3)
-    {
-        for (int i = 0; i < VOCband2; i++)
-        {
-            leds1[i] = strip2Color;
-        }
-    }
-}
-
-bool strip1_has_fade()
-{
-    if (leds0[0].getAverageLight() == 0)
-    {
-        return true;
-    }
-    else
-    {
-        return false;
-    }
+    strip2Color.val = brightlvl;
+    colour.nscale8_video(brightlvl);
+    blend_fill(strip2leds, strip2numLeds, colour);
 }
 
-bool strip2_has_fade()
+bool strip1_has_fade() //stops at the first lit pixel, so it is only slow once nearly faded
 {
-    if (SCULPTURE_ID == 1)
+    for (int i = 0; i < strip1numLeds; i++)
     {
-        if (leds3[0].getAverageLight() == 0)
-        {
-            return true;
-        }
-        else
+        if (strip1leds[i])
         {
             return false;
         }
     }
-    else
+    return true;
+}
+
+bool strip2_has_fade() //stops at the first lit pixel, so it is only slow once nearly faded
+{
+    for (int i = 0; i < strip2numLeds; i++)
     {
-        if (leds1[0].getAverageLight() == 0)
-        {
-            return true;
-        }
-        else
+        if (strip2leds[i])
         {
             return false;
         }
     }
+    return true;
 }
 
 /*--------------------------------------------------------------------------------
-  Tracks fade animation bright levels
+  Idle fade animation. The pulse runs off the shared clock (see sync.h), so the strips
+  and sculptures pulse together whatever the frame rate. After playback the strip
+  rises from black until it meets the pulse.
 --------------------------------------------------------------------------------*/
-int strip1_get_brightness(int _brightness)
-{
-    if (!strip1isMaxBrightness)
-    {
-        _brightness++;
-        if (_brightness > strip1maxBrightLvl)
-            _brightness = strip1maxBrightLvl;
-        return _brightness;
-    }
-    else //reached max brightness
-    {
-        _brightness--;
-        if (_brightness < 0)
-            _brightness = 0;
-        return _brightness;
-    }
-}
+const unsigned int IDLE_PULSE_STEP_MS = 20; //256 steps up and down, a 5s pulse
 
-int strip2_get_brightness(int _brightness)
+uint8_t idle_pulse_level(int maxBrightLvl)
 {
-    if (!strip2isMaxBrightness)
-    {
-        _brightness++;
-        if (_brightness > strip2maxBrightLvl)
-            _brightness = strip2maxBrightLvl;
-        return _brightness;
-    }
-    else //reached max brightness
-    {
-        _brightness--;
-        if (_brightness < 0)
-            _brightness = 0;
-        return _brightness;
-    }
+    return scale8(triwave8(sync_millis() / IDLE_PULSE_STEP_MS), maxBrightLvl);
 }
 
-/*--------------------------------------------------------------------------------
-  Idle fade animation
---------------------------------------------------------------------------------*/
 void strip1_idle_animation()
 {
-    int brightlevel = strip1_get_brightness(strip1brightness);
-    strip1Color.val = strip1brightness = brightlevel;
-
-    if (SCULPTURE_ID == 1)
-    {
-        for (int i = 0; i < CO2band1_1; i++)
-        {
-            leds0[i] = strip1Color;
-        }
-        for (int i = 0; i < CO2band1_2; i++)
-        {
-            leds1[i] = strip1Color;
-        }
-        for (int i = 0; i < CO2band1_3; i++)
-        {
-            leds2[i] = strip1Color;
-        }
-    }
-    else if (SCULPTURE_ID == 2)
-    {
-        for (int i = 0; i < PM25band1; i++)
-        {
-            leds0[i] = strip1Color;
-        }
-    }
-    else if (SCULPTURE_ID == 3)
-    {
-        for (int i = 0; i < VOCband1; i++)
-        {
-            leds0[i] = strip1Color;
-        }
-    }
-    if (brightlevel == strip1maxBrightLvl)
-    {
-        strip1isMaxBrightness = true;
-    }
-    else if (brightlevel == 0)
-    {
-        strip1isMaxBrightness = false;
-    }
+    int level = idle_pulse_level(strip1maxBrightLvl);
+    strip1brightness = (strip1brightness < level) ? strip1brightness + 1 : level;
+    strip1Color.val = strip1brightness;
+    blend_fill(strip1leds, strip1numLeds, strip1Color);
 }
 
 void strip2_idle_animation()
 {
-    int brightlevel = strip2_get_brightness(strip2brightness);
-    strip2Color.val = strip2brightness = brightlevel;
-
-    if (SCULPTURE_ID == 1)
-    {
-        for (int i = 0; i < CO2band2; i++)
-        {
-            leds3[i] = strip2Color;
-        }
-    }
-    else if (SCULPTURE_ID == 2)
-    {
-        for (int i = 0; i < PM25band2; i++)
-        {
-            leds1[i] = strip2Color;
-        }
-    }
-    else if (SCULPTURE_ID == 3)
-    {
-        for (int i = 0; i < VOCband2; i++)
-        {
-            leds1[i] = strip2Color;
-        }
-    }
-    if (brightlevel == strip2maxBrightLvl)
-    {
-        strip2isMaxBrightness = true;
-    }
-    else if (brightlevel == 0)
-    {
-        strip2isMaxBrightness = false;
-    }
+    int level = idle_pulse_level(strip2maxBrightLvl);
+    strip2brightness = (strip2brightness < level) ? strip2brightness + 1 : level;
+    strip2Color.val = strip2brightness;
+    blend_fill(strip2leds, strip2numLeds, strip2Color);
 }
 
 /*--------------------------------------------------------------------------------
@@ -447,14 +375,13 @@ void strip1_go_idle()
     strip1activeLedState = 0; //go to idle state
     strip1playMode = IDLE_MODE;
     strip1hasPlayModeChanged = true; //trigger sound change
-    strip1bandDelay = BAND_DELAY;
+    analytics_on_playback_end(0);
+    rec_log_mode(0, IDLE_MODE);
     strip1maxBrightLvl = 255;
-    Serial.println("strip1 : IDLE MODE");
-    strip1isMaxBrightness = false;
+    debugSerial.println("strip1 : IDLE MODE");
     strip1brightness = 0;
     strip1bandms = 0;
     strip1Color = idleColor;
-    // sgtl5000_1.volume(0.5); //uncomment when audio added
 }
 
 void strip2_go_idle()
@@ -462,14 +389,13 @@ void strip2_go_idle()
     strip2activeLedState = 0; //go to idle state
     strip2playMode = IDLE_MODE;
     strip2hasPlayModeChanged = true; //trigger sound change
-    strip2bandDelay = BAND_DELAY;
+    analytics_on_playback_end(1);
+    rec_log_mode(1, IDLE_MODE);
     strip2maxBrightLvl = 255;
-    Serial.println("strip 2: IDLE MODE");
-    strip2isMaxBrightness = false;
+    debugSerial.println("strip 2: IDLE MODE");
     strip2brightness = 0;
     strip2bandms = 0;
     strip2Color = idleColor;
-    // sgtl5000_1.volume(0.5); //uncomment when audio added
 }
 
 /*--------------------------------------------------------------------------------
@@ -481,56 +407,71 @@ void strip1_playback_readings()
     {
         strip1_fade();
 
-        if (strip1_has_fade() == true)
+        if (strip1_has_fade() == true && (!isLinkedPlayback || strip2_has_fade())) //linked strips start together
         {
             strip1activeLedState = 1;
             strip1bandms = 0;
+            strip1phase = 0;
             strip1readingsCounter = 0;
-            strip1currBrightVal = strip1prevBrightVal = 0;
+            strip1prevBrightVal = 0;
+            dataset_open(0, strip1data); //live history, uploaded or built in data set, see dataset.h
             strip1Color.val = 0;
+
+            if (playbackStyle == PLAYBACK_PROGRAM)
+            {
+                vm_start(strip1vm); //the program reads the data set itself
+            }
+            else
+            {
+                strip1currBrightVal = dataset_next(strip1data);
+                wave_clear(strip1waves);
+                wave_launch(strip1waves, strip1currBrightVal);
+            }
         }
     }
     else if (strip1activeLedState == 1)
     {
-        if (strip1bandms < BAND_DELAY * 2) //control the speed of the fade animation here
-        {
-            strip1currBrightVal = readings1[strip1readingsCounter];
+        bool isNextReading = isLinkedPlayback ? advance_linked_phase(strip1phase, 0) : advance_phase(strip1phase, strip1bandms);
 
-            if (strip1currBrightVal > strip1prevBrightVal)
-            {
-                if (strip1Color.val < strip1currBrightVal)
-                {
-                    strip1Color.val += 10; //brighten
-                }
-            }
-            else //curr is < prev bright val
+        if (playbackStyle == PLAYBACK_PROGRAM)
+        {
+            if (!vm_run(strip1vm, strip1leds, strip1numLeds, strip1data, isNextReading))
             {
-                if (strip1Color.val > strip1currBrightVal)
-                {
-                    strip1Color.val -= 10; //dim
-                }
+                strip1activeLedState = 2; //program has ended
             }
-
-            strip1_set_brightLevel(strip1Color.val);
+            return;
         }
-        else //go to next bright value
+
+        if (isNextReading) //go to next bright value
         {
             strip1prevBrightVal = strip1currBrightVal;
             strip1readingsCounter++;
 
-            Serial.print("strip1readingsCounter: ");
-            Serial.print(strip1readingsCounter);
-            Serial.print("\t strip1currBrightVal: ");
-            Serial.println(strip1currBrightVal);
-
-            strip1bandms = 0; //need to reset here
+            debugSerial.print("strip1readingsCounter: ");
+            debugSerial.print(strip1readingsCounter);
+            debugSerial.print("\t strip1currBrightVal: ");
+            debugSerial.println(strip1currBrightVal);
 
-            unsigned int numElements = sizeof(readings1) / sizeof(readings1[0]);
-
-            if (strip1readingsCounter == numElements)
+            if (dataset_done(strip1data))
             {
                 strip1activeLedState = 2; //go to next state
             }
+            else
+            {
+                strip1currBrightVal = dataset_next(strip1data);
+                wave_launch(strip1waves, strip1currBrightVal);
+            }
+        }
+
+        uint8_t level = lerp8by8(strip1prevBrightVal, strip1currBrightVal, crossfade_amount(strip1phase));
+
+        if (playbackStyle == PLAYBACK_WAVES)
+        {
+            wave_draw(strip1waves, strip1leds, strip1numLeds, level);
+        }
+        else
+        {
+            strip1_set_brightLevel(level);
         }
     }
     else if (strip1activeLedState == 2)
@@ -550,116 +491,80 @@ void strip2_playback_readings()
     {
         strip2_fade();
 
-        if (strip2_has_fade() == true)
+        if (strip2_has_fade() == true && (!isLinkedPlayback || strip1_has_fade())) //linked strips start together
         {
             strip2activeLedState = 1;
             strip2bandms = 0;
+            strip2phase = 0;
             strip2readingsCounter = 0;
-            strip2currBrightVal = strip2prevBrightVal = 0;
+            strip2prevBrightVal = 0;
+            dataset_open(1, strip2data); //live history, uploaded or built in data set, see dataset.h
             strip2Color.val = 0;
+
+            if (playbackStyle == PLAYBACK_PROGRAM)
+            {
+                vm_start(strip2vm); //the program reads the data set itself
+            }
+            else
+            {
+                strip2currBrightVal = dataset_next(strip2data);
+                wave_clear(strip2waves);
+                wave_launch(strip2waves, strip2currBrightVal);
+            }
         }
     }
     else if (strip2activeLedState == 1)
     {
-        if (strip2bandms < BAND_DELAY * 2) //control the speed of the fade animation here
-        {
-            strip2currBrightVal = readings2[strip2readingsCounter];
+        bool isNextReading = isLinkedPlayback ? advance_linked_phase(strip2phase, 1) : advance_phase(strip2phase, strip2bandms);
 
-            if (strip2currBrightVal > strip2prevBrightVal)
-            {
-                if (strip2Color.val < strip2currBrightVal)
-                {
-                    strip2Color.val += 10; //brighten
-                }
-            }
-            else //curr is < prev bright val
+        if (playbackStyle == PLAYBACK_PROGRAM)
+        {
+            if (!vm_run(strip2vm, strip2leds, strip2numLeds, strip2data, isNextReading))
             {
-                if (strip2Color.val > strip2currBrightVal)
-                {
-                    strip2Color.val -= 10; //dim
-                }
+                strip2activeLedState = 2; //program has ended
             }
-
-            strip2_set_brightLevel(strip2Color.val);
+            return;
         }
-        else //go to next bright value
+
+        if (isNextReading) //go to next bright value
         {
             strip2prevBrightVal = strip2currBrightVal;
             strip2readingsCounter++;
 
-            Serial.print("strip2readingsCounter: ");
-            Serial.print(strip2readingsCounter);
-            Serial.print("\t strip2currBrightVal: ");
-            Serial.println(strip2currBrightVal);
-
-            strip2bandms = 0; //need to reset here
-
-            unsigned int numElements = sizeof(readings2) / sizeof(readings2[0]);
+            debugSerial.print("strip2readingsCounter: ");
+            debugSerial.print(strip2readingsCounter);
+            debugSerial.print("\t strip2currBrightVal: ");
+            debugSerial.println(strip2currBrightVal);
 
-            if (strip2readingsCounter == numElements)
+            if (dataset_done(strip2data))
             {
                 strip2activeLedState = 2; //go to next state
             }
+            else
+            {
+                strip2currBrightVal = dataset_next(strip2data);
+                wave_launch(strip2waves, strip2currBrightVal);
+            }
         }
-    }
-    else if (strip2activeLedState == 2)
-    {
-        strip2_fade();
 
-        if (strip2_has_fade())
-        {
-            strip2_go_idle();
-        }
-    }
-}
+        uint8_t level = lerp8by8(strip2prevBrightVal, strip2currBrightVal, crossfade_amount(strip2phase));
 
-/*--------------------------------------------------------------------------------
-  add glitter
---------------------------------------------------------------------------------*/
-void add_glitter()
-{
-    if (SCULPTURE_ID == 1)
-    {
-        if (random8() < 15) //random8() returns a rand num from 0 - 255
+        if (playbackStyle == PLAYBACK_WAVES)
         {
-            if (strip1playMode == IDLE_MODE) //only glitter in idle mode
-            {
-                leds0[random16(CO2band1_1)] += CRGB::White;
-                leds1[random16(CO2band1_2)] += CRGB::White;
-                leds2[random16(CO2band1_3)] += CRGB::White;
-            }
-            if (strip2playMode == IDLE_MODE)
-            {
-                leds3[random16(CO2band2)] += CRGB::White;
-            }
+            wave_draw(strip2waves, strip2leds, strip2numLeds, level);
         }
-    }
-    else if (SCULPTURE_ID == 2)
-    {
-        if (random8() < 35) //random8() returns a rand num from 0 - 255
+        else
         {
-            if (strip1playMode == IDLE_MODE) //only glitter in idle mode
-            {
-                leds0[random16(PM25band1)] += CRGB::White;
-            }
-            if (strip2playMode == IDLE_MODE)
-            {
-                leds1[random16(PM25band2)] += CRGB::White;
-            }
+            strip2_set_brightLevel(level);
         }
     }
-    else if (SCULPTURE_ID == 3)
+    else if (strip2activeLedState == 2)
     {
-        if (random8() < 55) //random8() returns a rand num from 0 - 255
+        strip2_fade();
+
+        if (strip2_has_fade())
         {
-            if (strip1playMode == IDLE_MODE) //only glitter in idle mode
-            {
-                leds0[random16(VOCband1)] += CRGB::White;
-            }
-            if (strip2playMode == IDLE_MODE)
-            {
-                leds1[random16(VOCband2)] += CRGB::White;
-            }
+            strip2_go_idle();
         }
     }
 }
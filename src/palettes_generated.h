@@ -0,0 +1,71 @@
+// Generated by scripts/gen_palettes.py, do not edit.
+
+#pragma once
+
+const uint8_t AIR_QUALITY_PALETTE[256 * 3] PROGMEM = {
+    0, 255, 0, 2, 255, 0, 4, 255, 0, 6, 255, 0, 8, 255, 0, 10, 255, 0, 12, 255, 0, 14, 255, 0,
+    16, 255, 0, 18, 255, 0, 20, 255, 0, 22, 255, 0, 24, 255, 0, 26, 255, 0, 28, 255, 0, 30, 255, 0,
+    32, 255, 0, 34, 255, 0, 36, 255, 0, 38, 255, 0, 40, 255, 0, 42, 255, 0, 44, 255, 0, 46, 255, 0,
+    48, 255, 0, 50, 255, 0, 52, 255, 0, 54, 255, 0, 56, 255, 0, 58, 255, 0, 60, 255, 0, 62, 255, 0,
+    64, 255, 0, 66, 255, 0, 68, 255, 0, 70, 255, 0, 72, 255, 0, 74, 255, 0, 76, 255, 0, 78, 255, 0,
+    80, 255, 0, 82, 255, 0, 84, 255, 0, 86, 255, 0, 88, 255, 0, 90, 255, 0, 92, 255, 0, 94, 255, 0,
+    96, 255, 0, 98, 255, 0, 100, 255, 0, 102, 255, 0, 104, 255, 0, 106, 255, 0, 108, 255, 0, 110, 255, 0,
+    112, 255, 0, 114, 255, 0, 116, 255, 0, 118, 255, 0, 120, 255, 0, 122, 255, 0, 124, 255, 0, 126, 255, 0,
+    128, 255, 0, 130, 254, 0, 132, 253, 0, 134, 252, 0, 136, 251, 0, 138, 250, 0, 140, 249, 0, 142, 248, 0,
+    144, 247, 0, 146, 246, 0, 148, 245, 0, 150, 244, 0, 152, 243, 0, 154, 242, 0, 156, 241, 0, 158, 240, 0,
+    160, 240, 0, 162, 239, 0, 164, 238, 0, 166, 237, 0, 168, 236, 0, 170, 235, 0, 172, 234, 0, 174, 233, 0,
+    176, 232, 0, 178, 231, 0, 180, 230, 0, 182, 229, 0, 184, 228, 0, 186, 227, 0, 188, 226, 0, 190, 225, 0,
+    192, 224, 0, 194, 223, 0, 196, 221, 0, 198, 220, 0, 200, 218, 0, 202, 217, 0, 204, 215, 0, 206, 214, 0,
+    208, 212, 0, 210, 211, 0, 212, 209, 0, 214, 208, 0, 216, 206, 0, 218, 205, 0, 220, 203, 0, 222, 202, 0,
+    224, 200, 0, 226, 198, 0, 228, 197, 0, 230, 195, 0, 232, 194, 0, 234, 192, 0, 236, 191, 0, 238, 189, 0,
+    240, 188, 0, 242, 186, 0, 244, 185, 0, 246, 183, 0, 248, 182, 0, 250, 180, 0, 252, 179, 0, 254, 177, 0,
+    255, 176, 0, 255, 175, 0, 255, 173, 0, 255, 172, 0, 255, 170, 0, 255, 169, 0, 255, 167, 0, 255, 166, 0,
+    255, 164, 0, 255, 163, 0, 255, 161, 0, 255, 160, 0, 255, 158, 0, 255, 157, 0, 255, 155, 0, 255, 154, 0,
+    255, 152, 0, 255, 150, 0, 255, 149, 0, 255, 147, 0, 255, 146, 0, 255, 144, 0, 255, 143, 0, 255, 141, 0,
+    255, 140, 0, 255, 138, 0, 255, 137, 0, 255, 135, 0, 255, 134, 0, 255, 132, 0, 255, 131, 0, 255, 129, 0,
+    255, 128, 0, 255, 126, 0, 255, 124, 0, 255, 122, 0, 255, 120, 0, 255, 118, 0, 255, 116, 0, 255, 114, 0,
+    255, 112, 0, 255, 110, 0, 255, 108, 0, 255, 106, 0, 255, 104, 0, 255, 102, 0, 255, 100, 0, 255, 98, 0,
+    255, 96, 0, 255, 94, 0, 255, 92, 0, 255, 90, 0, 255, 88, 0, 255, 86, 0, 255, 84, 0, 255, 82, 0,
+    255, 80, 0, 255, 78, 0, 255, 76, 0, 255, 74, 0, 255, 72, 0, 255, 70, 0, 255, 68, 0, 255, 66, 0,
+    255, 64, 0, 255, 62, 0, 255, 61, 0, 255, 59, 0, 255, 58, 0, 255, 56, 0, 255, 55, 0, 255, 53, 0,
+    255, 52, 0, 255, 50, 0, 255, 49, 0, 255, 47, 0, 255, 46, 0, 255, 44, 0, 255, 43, 0, 255, 41, 0,
+    255, 40, 0, 255, 38, 0, 255, 37, 0, 255, 35, 0, 255, 34, 0, 255, 32, 0, 255, 31, 0, 255, 29, 0,
+    255, 28, 0, 255, 26, 0, 255, 25, 0, 255, 23, 0, 255, 22, 0, 255, 20, 0, 255, 19, 0, 255, 17, 0,
+    255, 16, 0, 255, 15, 0, 255, 14, 0, 255, 13, 0, 255, 12, 0, 255, 11, 0, 255, 10, 0, 255, 9, 0,
+    255, 8, 0, 255, 7, 0, 255, 6, 0, 255, 5, 0, 255, 4, 0, 255, 3, 0, 255, 2, 0, 255, 1, 0,
+    255, 0, 0, 255, 0, 0, 255, 0, 0, 255, 0, 0, 255, 0, 0, 255, 0, 0, 255, 0, 0, 255, 0, 0,
+    255, 0, 0, 255, 0, 0, 255, 0, 0, 255, 0, 0, 255, 0, 0, 255, 0, 0, 255, 0, 0, 255, 0, 0};
+
+const uint8_t AQI_PALETTE[256 * 3] PROGMEM = {
+    0, 228, 0, 4, 228, 0, 8, 228, 0, 12, 229, 0, 16, 229, 0, 20, 229, 0, 24, 229, 0, 28, 230, 0,
+    32, 230, 0, 36, 230, 0, 40, 230, 0, 44, 231, 0, 48, 231, 0, 52, 231, 0, 56, 231, 0, 60, 232, 0,
+    64, 232, 0, 68, 232, 0, 72, 233, 0, 76, 233, 0, 80, 234, 0, 84, 234, 0, 88, 235, 0, 92, 235, 0,
+    96, 236, 0, 100, 236, 0, 104, 237, 0, 108, 237, 0, 112, 238, 0, 116, 238, 0, 120, 239, 0, 124, 239, 0,
+    128, 240, 0, 132, 241, 0, 136, 241, 0, 140, 242, 0, 144, 242, 0, 148, 243, 0, 152, 243, 0, 156, 244, 0,
+    160, 244, 0, 164, 245, 0, 168, 245, 0, 172, 246, 0, 176, 246, 0, 180, 247, 0, 184, 247, 0, 188, 248, 0,
+    192, 248, 0, 196, 248, 0, 200, 249, 0, 204, 249, 0, 208, 250, 0, 212, 250, 0, 216, 251, 0, 220, 251, 0,
+    224, 252, 0, 228, 252, 0, 232, 253, 0, 236, 253, 0, 240, 254, 0, 244, 254, 0, 248, 255, 0, 252, 255, 0,
+    255, 255, 0, 255, 253, 0, 255, 250, 0, 255, 248, 0, 255, 245, 0, 255, 243, 0, 255, 240, 0, 255, 238, 0,
+    255, 235, 0, 255, 233, 0, 255, 230, 0, 255, 228, 0, 255, 225, 0, 255, 223, 0, 255, 220, 0, 255, 218, 0,
+    255, 216, 0, 255, 213, 0, 255, 211, 0, 255, 208, 0, 255, 206, 0, 255, 203, 0, 255, 201, 0, 255, 198, 0,
+    255, 196, 0, 255, 193, 0, 255, 191, 0, 255, 188, 0, 255, 186, 0, 255, 183, 0, 255, 181, 0, 255, 178, 0,
+    255, 176, 0, 255, 173, 0, 255, 170, 0, 255, 167, 0, 255, 163, 0, 255, 160, 0, 255, 157, 0, 255, 154, 0,
+    255, 151, 0, 255, 148, 0, 255, 145, 0, 255, 142, 0, 255, 138, 0, 255, 135, 0, 255, 132, 0, 255, 129, 0,
+    255, 126, 0, 255, 123, 0, 255, 120, 0, 255, 117, 0, 255, 114, 0, 255, 111, 0, 255, 108, 0, 255, 105, 0,
+    255, 103, 0, 255, 100, 0, 255, 97, 0, 255, 94, 0, 255, 91, 0, 255, 88, 0, 255, 85, 0, 255, 82, 0,
+    255, 80, 0, 255, 77, 0, 255, 74, 0, 255, 71, 0, 255, 68, 0, 255, 65, 0, 255, 62, 0, 255, 59, 0,
+    255, 56, 0, 255, 53, 0, 255, 50, 0, 255, 47, 0, 255, 44, 0, 255, 41, 0, 255, 38, 0, 255, 35, 0,
+    255, 32, 0, 255, 30, 0, 255, 28, 0, 255, 26, 0, 255, 24, 0, 255, 22, 0, 255, 20, 0, 255, 18, 0,
+    255, 16, 0, 255, 14, 0, 255, 12, 0, 255, 10, 0, 255, 8, 0, 255, 6, 0, 255, 4, 0, 255, 2, 0,
+    255, 0, 0, 252, 0, 3, 249, 0, 6, 246, 0, 9, 243, 0, 12, 240, 0, 15, 237, 0, 18, 234, 0, 21,
+    231, 0, 24, 228, 0, 27, 225, 0, 30, 222, 0, 33, 219, 0, 36, 216, 0, 39, 213, 0, 42, 210, 0, 45,
+    208, 0, 48, 205, 0, 51, 202, 0, 54, 199, 0, 57, 196, 0, 60, 193, 0, 63, 190, 0, 66, 187, 0, 69,
+    184, 0, 72, 181, 0, 75, 178, 0, 78, 175, 0, 81, 172, 0, 84, 169, 0, 87, 166, 0, 90, 163, 0, 93,
+    160, 0, 96, 159, 4, 100, 158, 8, 103, 157, 12, 106, 156, 15, 110, 155, 19, 113, 154, 23, 117, 153, 27, 120,
+    152, 31, 124, 150, 35, 127, 149, 39, 130, 148, 43, 134, 147, 47, 137, 146, 51, 141, 145, 55, 144, 144, 59, 148,
+    143, 63, 151, 142, 61, 150, 141, 59, 150, 140, 57, 148, 139, 55, 148, 138, 53, 147, 137, 51, 147, 136, 49, 145,
+    135, 47, 145, 134, 45, 145, 133, 43, 144, 132, 41, 143, 131, 39, 142, 130, 37, 142, 129, 35, 141, 128, 33, 140,
+    128, 32, 140, 128, 30, 139, 128, 28, 138, 128, 26, 137, 127, 24, 137, 127, 22, 136, 127, 20, 135, 127, 18, 134,
+    127, 16, 134, 127, 14, 133, 127, 12, 132, 127, 10, 131, 126, 8, 131, 126, 6, 130, 126, 4, 129, 126, 2, 128,
+    126, 0, 128, 126, 0, 128, 126, 0, 128, 126, 0, 128, 126, 0, 128, 126, 0, 128, 126, 0, 128, 126, 0, 128,
+    126, 0, 128, 126, 0, 128, 126, 0, 128, 126, 0, 128, 126, 0, 128, 126, 0, 128, 126, 0, 128, 126, 0, 128};
@@ -0,0 +1,141 @@
+/*--------------------------------------------------------------------------------
+  Sculpture profiles. All three sculptures are built into the one firmware image and
+  the active one is picked from EEPROM at boot. Everything that differs between them
+  is either data in the table below or one of its function pointers, so loop() never
+  has to check SCULPTURE_ID.
+--------------------------------------------------------------------------------*/
+
+const uint8_t SENSOR_NONE = 0, SENSOR_MHZ19 = 1, SENSOR_SDS011 = 2; //live sensor on Serial1, see livesensor.h
+
+struct SculptureProfile
+{
+    uint8_t id;
+    const char *name;
+    int strip1numLeds, strip2numLeds;
+    const FlashDataset *const *catalogue[2]; //built in data sets per button, see datasets_generated.h
+    uint8_t catalogueLen[2];
+    const uint8_t *palette;   //colour of a reading by its brightness, see palettes_generated.h
+    uint8_t glitterChance;    //out of 255, per frame
+    uint8_t liveSensor;
+    void (*add_leds)();       //led pins are template args so each sculpture needs its own setup
+    void (*add_glitter)();
+};
+
+SculptureProfile profile; //active profile, copied out of flash once at boot
+
+/*--------------------------------------------------------------------------------
+  FastLED setup per sculpture. The pointers into ledPool must line up with the strip
+  lengths in the table.
+--------------------------------------------------------------------------------*/
+void co2_add_leds() //top ring of CO2 sculpture split into 3 strips
+{
+    leds0 = strip1leds;
+    leds1 = leds0 + CO2band1_1;
+    leds2 = leds1 + CO2band1_2;
+    leds3 = strip2leds;
+
+    FastLED.addLeds<LED_TYPE, CO2STRIP1_1PIN, COLOR_ORDER>(leds0, CO2band1_1);
+    FastLED.addLeds<LED_TYPE, CO2STRIP1_2PIN, COLOR_ORDER>(leds1, CO2band1_2);
+    FastLED.addLeds<LED_TYPE, CO2STRIP1_3PIN, COLOR_ORDER>(leds2, CO2band1_3);
+    FastLED.addLeds<LED_TYPE, CO2STRIP2PIN, COLOR_ORDER>(leds3, CO2band2);
+}
+
+void two_strip_add_leds() //PM25 and VOC
+{
+    leds0 = strip1leds;
+    leds1 = strip2leds;
+
+    FastLED.addLeds<LED_TYPE, STRIP1PIN, COLOR_ORDER>(leds0, strip1numLeds);
+    FastLED.addLeds<LED_TYPE, STRIP2PIN, COLOR_ORDER>(leds1, strip2numLeds);
+}
+
+/*--------------------------------------------------------------------------------
+  add glitter
+--------------------------------------------------------------------------------*/
+void co2_add_glitter() //one sparkle on each of the 3 strips of the top ring
+{
+    if (random8() < profile.glitterChance) //random8() returns a rand num from 0 - 255
+    {
+        if (strip1playMode == IDLE_MODE) //only glitter in idle mode
+        {
+            blend_pixel(leds0[random16(CO2band1_1)], CRGB::White);
+            blend_pixel(leds1[random16(CO2band1_2)], CRGB::White);
+            blend_pixel(leds2[random16(CO2band1_3)], CRGB::White);
+        }
+        if (strip2playMode == IDLE_MODE)
+        {
+            blend_pixel(leds3[random16(CO2band2)], CRGB::White);
+        }
+    }
+}
+
+void two_strip_add_glitter()
+{
+    if (random8() < profile.glitterChance) //random8() returns a rand num from 0 - 255
+    {
+        if (strip1playMode == IDLE_MODE) //only glitter in idle mode
+        {
+            blend_pixel(strip1leds[random16(strip1numLeds)], CRGB::White);
+        }
+        if (strip2playMode == IDLE_MODE)
+        {
+            blend_pixel(strip2leds[random16(strip2numLeds)], CRGB::White);
+        }
+    }
+}
+
+/*--------------------------------------------------------------------------------
+  Colour of a brightness level in the sculpture's palette, one 3 byte flash read
+--------------------------------------------------------------------------------*/
+CRGB palette_colour(uint8_t level)
+{
+    CRGB colour;
+    memcpy_P(colour.raw, profile.palette + 3 * level, 3);
+    return colour;
+}
+
+#define CATALOGUE_LEN(catalogue) (sizeof(catalogue) / sizeof(catalogue[0]))
+
+const SculptureProfile SCULPTURE_PROFILES[3] PROGMEM = {
+    {CO2_ID, "CO2", CO2band1_1 + CO2band1_2 + CO2band1_3, CO2band2, {CO2_CATALOGUE0, CO2_CATALOGUE1}, {CATALOGUE_LEN(CO2_CATALOGUE0), CATALOGUE_LEN(CO2_CATALOGUE1)}, AIR_QUALITY_PALETTE, 15, SENSOR_MHZ19, co2_add_leds, co2_add_glitter},
+    {PM25_ID, "PM25", PM25band1, PM25band2, {PM25_CATALOGUE0, PM25_CATALOGUE1}, {CATALOGUE_LEN(PM25_CATALOGUE0), CATALOGUE_LEN(PM25_CATALOGUE1)}, AQI_PALETTE, 35, SENSOR_SDS011, two_strip_add_leds, two_strip_add_glitter},
+    {VOC_ID, "VOC", VOCband1, VOCband2, {VOC_CATALOGUE0, VOC_CATALOGUE1}, {CATALOGUE_LEN(VOC_CATALOGUE0), CATALOGUE_LEN(VOC_CATALOGUE1)}, AIR_QUALITY_PALETTE, 55, SENSOR_NONE, two_strip_add_leds, two_strip_add_glitter}};
+
+/*--------------------------------------------------------------------------------
+  Done once during setup(), after config_begin(). Takes the sculpture ID from the
+  config store and sets up the strip layout. An ID sent over serial during the power
+  up delay is saved and used instead.
+--------------------------------------------------------------------------------*/
+void load_profile()
+{
+    uint8_t id = (configLen > CONFIG_SCULPTURE_ID) ? configPayload[CONFIG_SCULPTURE_ID] : DEFAULT_SCULPTURE_ID;
+
+    while (Serial.available() > 0)
+    {
+        char c = Serial.read();
+
+        if (c >= '0' + CO2_ID && c <= '0' + VOC_ID)
+        {
+            id = c - '0';
+            configPayload[CONFIG_SCULPTURE_ID] = id;
+            configLen = max(configLen, uint8_t(CONFIG_PARAMS));
+            config_save();
+            config_write_now();
+        }
+    }
+
+    if (id < CO2_ID || id > VOC_ID) //blank EEPROM reads 255
+    {
+        id = DEFAULT_SCULPTURE_ID;
+    }
+
+    memcpy_P(&profile, &SCULPTURE_PROFILES[id - 1], sizeof(SculptureProfile));
+    SCULPTURE_ID = id;
+
+    strip1numLeds = profile.strip1numLeds;
+    strip2numLeds = profile.strip2numLeds;
+    strip2leds = strip1leds + strip1numLeds;
+
+    Serial.print("Sculpture: ");
+    Serial.println(profile.name);
+}
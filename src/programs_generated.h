@@ -0,0 +1,21 @@
+// Generated by scripts/anim_asm.py from programs/*.anim, do not edit.
+
+#pragma once
+
+struct AnimProgram
+{
+    const uint8_t *code;
+    uint16_t len;
+};
+
+// ease.anim, 18 bytes
+const uint8_t EASE_CODE[18] PROGMEM = {9, 0, 32, 7, 0, 17, 3, 0, 5, 1, 8, 6, 7, 0, 17, 11, 6, 0};
+
+// flash.anim, 22 bytes
+const uint8_t FLASH_CODE[22] PROGMEM = {7, 0, 21, 3, 0, 1, 1, 20, 4, 24, 5, 1, 6, 1, 8, 5, 1, 8, 15, 11, 0, 0};
+
+// sparkle.anim, 23 bytes
+const uint8_t SPARKLE_CODE[23] PROGMEM = {7, 0, 22, 9, 0, 255, 3, 0, 9, 1, 255, 10, 0, 5, 1, 8, 3, 7, 0, 22, 11, 3, 0};
+
+const AnimProgram ANIM_PROGRAMS[3] PROGMEM = {{EASE_CODE, 18}, {FLASH_CODE, 22}, {SPARKLE_CODE, 23}};
+const uint8_t NUM_ANIM_PROGRAMS = 3;
@@ -0,0 +1,301 @@
+/*--------------------------------------------------------------------------------
+  Black box recorder. The inputs (local button presses, dist sensor readings) and the
+  play mode changes they cause are logged into a RAM ring, the oldest events dropped
+  to make room. Logging straight to EEPROM would wear it out within a year of visitors.
+  The tuning console (see console.h) controls it:
+    rec save : copies the ring to EEPROM_RECORDER_ADDR, a byte per loop(), so it
+               survives the sculpture being power cycled. Logging pauses meanwhile.
+    rec play : replays the saved log. read_console() takes the buttons and readings
+               from the log instead, in the same order and at the same intervals, and
+               set_playMode() runs them as usual. Each mode change is checked against
+               the next one logged, and any that differs is printed.
+    rec stop : ends a replay
+  scripts/recorder_dump.py reads the saved log with 'R' frames (see upload.h).
+  test/host/recorder_check.cpp checks the ring wrap, save and replay on a PC.
+
+  Events, oldest first
+      type << 4 | arg, ms since the previous event (LEB128 varint), [reading]
+    REC_BUTTON : arg is the button
+    REC_RANGE  : reading is the distance / 8, REC_NO_RANGE for none. Logged only when
+                 it changes, so a visitor standing still costs nothing.
+    REC_MODE   : arg is strip << 2 | mode
+  Most events are 2 or 3 bytes, so the ring holds a few minutes of a busy gallery.
+  Replays start with both strips idle. A log that starts half way through a playback
+  differs at first until that strip is idle again.
+--------------------------------------------------------------------------------*/
+
+const uint8_t REC_BUTTON = 1, REC_RANGE = 2, REC_MODE = 3;
+const uint8_t REC_NO_RANGE = 255;
+const uint16_t REC_RING_SIZE = 512;
+const uint8_t REC_EVENT_MAX = 5;        //type, 3 byte varint, reading
+const uint8_t REC_MAGIC = 0xB7;
+const uint8_t REC_HEADER_SIZE = 3;      //magic, len (uint16), then the events
+
+uint8_t recRing[REC_RING_SIZE];
+uint16_t recHead = 0, recTail = 0, recUsed = 0; //next byte written, oldest event, bytes in use
+uint32_t recLastms;
+uint8_t recLastRange = REC_NO_RANGE;
+
+uint16_t recSaveStep = 0, recSaveLen = 0;
+bool isRecSaving = false;
+
+bool isReplaying = false;
+uint16_t replayPos, replayEnd;          //EEPROM addresses of the next event and the end
+uint16_t replayModePos;                 //of the next logged mode change, to check against
+uint32_t replayNextms;
+bool isReplayRangeDue = false;          //a reading was replayed, set the playback speed
+uint16_t replayModesMatched, replayModesDiffered;
+
+/*--------------------------------------------------------------------------------
+  Length of the event starting at ring offset pos
+--------------------------------------------------------------------------------*/
+uint8_t rec_event_len(uint16_t pos)
+{
+    uint8_t type = recRing[pos] >> 4;
+    uint8_t len = 1;
+
+    while (recRing[(pos + len) % REC_RING_SIZE] & 0x80)
+    {
+        len++;
+    }
+    len++; //last varint byte
+    return (type == REC_RANGE) ? len + 1 : len;
+}
+
+void rec_put(uint8_t c)
+{
+    recRing[recHead] = c;
+    recHead = (recHead + 1) % REC_RING_SIZE;
+}
+
+void rec_log(uint8_t type, uint8_t arg, uint8_t reading)
+{
+    if (isRecSaving || isReplaying)
+    {
+        return;
+    }
+
+    while (recUsed + REC_EVENT_MAX > REC_RING_SIZE) //drop the oldest
+    {
+        uint8_t len = rec_event_len(recTail);
+        recTail = (recTail + len) % REC_RING_SIZE;
+        recUsed -= len;
+    }
+
+    uint16_t start = recHead;
+    uint32_t now = millis();
+    uint32_t dt = min(now - recLastms, 0x1FFFFFUL); //3 varint bytes, ~35 minutes
+    recLastms = now;
+
+    rec_put((type << 4) | arg);
+    while (dt >= 0x80)
+    {
+        rec_put(0x80 | (dt & 0x7F));
+        dt >>= 7;
+    }
+    rec_put(dt);
+    if (type == REC_RANGE)
+    {
+        rec_put(reading);
+    }
+    recUsed += (recHead + REC_RING_SIZE - start) % REC_RING_SIZE;
+}
+
+void rec_log_button(uint8_t button)
+{
+    rec_log(REC_BUTTON, button, 0);
+}
+
+void rec_log_range(bool isValid)
+{
+    uint8_t reading = isValid ? min(rangeVal / 8, REC_NO_RANGE - 1) : REC_NO_RANGE;
+
+    if (reading != recLastRange)
+    {
+        recLastRange = reading;
+        rec_log(REC_RANGE, 0, reading);
+    }
+}
+
+/*--------------------------------------------------------------------------------
+  Reads the event at EEPROM address pos, returns the address of the one after it
+--------------------------------------------------------------------------------*/
+uint16_t replay_read_event(uint16_t pos, uint8_t &type, uint8_t &arg, uint32_t &dt, uint8_t &reading)
+{
+    uint8_t c = EEPROM.read(pos++);
+    type = c >> 4;
+    arg = c & 0x0F;
+
+    dt = 0;
+    uint8_t shift = 0;
+    do
+    {
+        c = EEPROM.read(pos++);
+        dt |= uint32_t(c & 0x7F) << shift;
+        shift += 7;
+    } while (c & 0x80);
+
+    reading = (type == REC_RANGE) ? EEPROM.read(pos++) : 0;
+    return pos;
+}
+
+/*--------------------------------------------------------------------------------
+  Called on every play mode change. Logs it, or while replaying checks it against the
+  next one in the log.
+--------------------------------------------------------------------------------*/
+void rec_log_mode(uint8_t strip, uint8_t mode)
+{
+    if (!isReplaying)
+    {
+        rec_log(REC_MODE, (strip << 2) | mode, 0);
+        return;
+    }
+
+    uint8_t type = 0, arg = 0, reading;
+    uint32_t dt;
+    while (replayModePos < replayEnd && type != REC_MODE)
+    {
+        replayModePos = replay_read_event(replayModePos, type, arg, dt, reading);
+    }
+
+    if (type == REC_MODE && arg == ((strip << 2) | mode))
+    {
+        replayModesMatched++;
+        return;
+    }
+
+    replayModesDiffered++;
+    debugSerial.print("replay: strip");
+    debugSerial.print(strip + 1);
+    debugSerial.print(mode == BUTTON_MODE ? " BUTTON MODE" : " IDLE MODE");
+    if (type == REC_MODE)
+    {
+        debugSerial.print(", logged strip");
+        debugSerial.print((arg >> 2) + 1);
+        debugSerial.println(((arg & 3) == BUTTON_MODE) ? " BUTTON MODE" : " IDLE MODE");
+    }
+    else
+    {
+        debugSerial.println(", not logged");
+    }
+}
+
+void rec_save()
+{
+    recSaveStep = 0;
+    recSaveLen = recUsed;
+    isRecSaving = true;
+}
+
+void replay_stop()
+{
+    isReplaying = false;
+    debugSerial.print("replay done, mode changes as logged: ");
+    debugSerial.print(replayModesMatched);
+    debugSerial.print(", different: ");
+    debugSerial.println(replayModesDiffered);
+}
+
+bool replay_start()
+{
+    uint16_t len = EEPROM.read(EEPROM_RECORDER_ADDR + 1) | (EEPROM.read(EEPROM_RECORDER_ADDR + 2) << 8);
+
+    if (EEPROM.read(EEPROM_RECORDER_ADDR) != REC_MAGIC || len > REC_RING_SIZE || len == 0)
+    {
+        Serial.println("replay: no saved log");
+        return false;
+    }
+    if (strip1playMode != IDLE_MODE || strip2playMode != IDLE_MODE || isRecSaving)
+    {
+        Serial.println("replay: wait for both strips to be idle");
+        return false;
+    }
+
+    replayPos = replayModePos = EEPROM_RECORDER_ADDR + REC_HEADER_SIZE;
+    replayEnd = replayPos + len;
+    replayNextms = millis(); //the first event's interval is to an event no longer in the log
+    replayModesMatched = replayModesDiffered = 0;
+    isReplaying = true;
+    return true;
+}
+
+/*--------------------------------------------------------------------------------
+  Called from read_console() while replaying, instead of reading the buttons. Plays
+  the events that are due, mode changes are only checked.
+--------------------------------------------------------------------------------*/
+void replay_read_inputs()
+{
+    while (isReplaying && int32_t(millis() - replayNextms) >= 0)
+    {
+        if (replayPos >= replayEnd)
+        {
+            replay_stop();
+            return;
+        }
+
+        uint8_t type, arg, reading;
+        uint32_t dt;
+        replayPos = replay_read_event(replayPos, type, arg, dt, reading);
+
+        if (type == REC_BUTTON && arg == 0)
+        {
+            isButton0Pressed = true;
+            debugSerial.println("replay: button0");
+        }
+        else if (type == REC_BUTTON && arg == 1)
+        {
+            isButton1Pressed = true;
+            debugSerial.println("replay: button1");
+        }
+        else if (type == REC_RANGE)
+        {
+            rangeVal = (reading == REC_NO_RANGE) ? 8190 : reading * 8; //none reads as far away
+            isUserPresent = (reading != REC_NO_RANGE && rangeVal <= int(presenceRange));
+            isReplayRangeDue = true;
+        }
+
+        if (replayPos < replayEnd) //interval to the next event
+        {
+            uint8_t nextType, nextArg, nextReading;
+            uint32_t nextDt;
+            replay_read_event(replayPos, nextType, nextArg, nextDt, nextReading);
+            replayNextms += nextDt;
+        }
+    }
+}
+
+/*--------------------------------------------------------------------------------
+  Called once per loop(). Writes at most one EEPROM byte of a save, the magic
+  cleared, the length, the events and the magic.
+--------------------------------------------------------------------------------*/
+void rec_service()
+{
+    if (!isRecSaving)
+    {
+        return;
+    }
+
+    const int addr = EEPROM_RECORDER_ADDR;
+
+    if (recSaveStep == 0)
+    {
+        EEPROM.update(addr, 0xFF);
+    }
+    else if (recSaveStep < REC_HEADER_SIZE)
+    {
+        EEPROM.update(addr + recSaveStep, uint8_t(recSaveLen >> (8 * (recSaveStep - 1))));
+    }
+    else if (recSaveStep < REC_HEADER_SIZE + recSaveLen)
+    {
+        uint16_t pos = recSaveStep - REC_HEADER_SIZE;
+        EEPROM.update(addr + recSaveStep, recRing[(recTail + pos) % REC_RING_SIZE]);
+    }
+    else
+    {
+        EEPROM.update(addr, REC_MAGIC);
+        isRecSaving = false;
+        debugSerial.print("recorder: saved bytes ");
+        debugSerial.println(recSaveLen);
+    }
+    recSaveStep++;
+}
@@ -0,0 +1,277 @@
+/*--------------------------------------------------------------------------------
+  Show schedule. A timeline of cues in EEPROM switches the show mode, brightness cap
+  and frame rate at set times of day, e.g. attract mode for tours and a dim night
+  mode for the cleaners. Write it with scripts/upload_cues.py (see upload.h).
+
+  Show modes
+    SHOW_NORMAL  : sparkle and presence glow as usual
+    SHOW_ATTRACT : stronger presence glow to pull visitors in
+    SHOW_NIGHT   : no sparkle or glow
+
+  Time of day comes from a DS3231 RTC on the I2C bus if there is one (SCL 21, SDA 20,
+  shared with the dist sensor), read at boot and hourly, otherwise from a time frame
+  sent over serial. clockSpeed makes it a virtual clock that runs faster, so a day of
+  cues can be tried out in minutes.
+
+  The cues are sorted by time. The next one is kept in RAM with its time, so each frame
+  is one comparison and a cue is read from EEPROM only when it comes due. The table is
+  only searched when the clock is set.
+--------------------------------------------------------------------------------*/
+
+const uint8_t SHOW_NORMAL = 0, SHOW_ATTRACT = 1, SHOW_NIGHT = 2, NUM_SHOW_MODES = 3;
+const uint8_t SHOW_SPARKLE_OPACITY[NUM_SHOW_MODES] = {255, 255, 0};
+const uint8_t SHOW_GLOW_OPACITY[NUM_SHOW_MODES] = {96, 192, 0};
+
+const uint8_t CUE_MAGIC = 0xC5;
+const uint8_t DS3231_ADDR = 0x68;
+const uint32_t SECONDS_PER_DAY = 86400UL;
+const uint16_t RTC_RESYNC_SECONDS = 3600;
+
+struct Cue
+{
+    uint16_t minute;    //of the day, 0 - 1439
+    uint8_t mode;       //SHOW_*
+    uint8_t brightness; //cap for FastLED.setBrightness()
+    uint8_t fps;        //frames per second, 0 for UPDATES_PER_SECOND
+};
+
+struct CueTableHeader //at EEPROM_CUES_ADDR, followed by the cues
+{
+    uint16_t len;  //bytes of cues
+    uint8_t magic; //written last
+};
+
+const int CUES_MAX_LEN = EEPROM_CUES_SIZE - sizeof(CueTableHeader);
+
+uint32_t clockSeconds;     //time of day
+uint32_t clockMsAcc;       //ms into the current second
+uint8_t clockSpeed = 1;    //1 for real time, more for a virtual clock
+elapsedMillis clockms;
+bool isClockSet = false, isRtcPresent = false;
+uint16_t rtcResyncCountdown;
+
+uint8_t numCues, nextCue;
+uint32_t nextCueSeconds;
+bool isNextCueTomorrow;    //next cue is the first of tomorrow's, wait for midnight
+uint8_t showMode = SHOW_NORMAL;
+
+uint8_t bcd_to_bin(uint8_t bcd)
+{
+    return (bcd >> 4) * 10 + (bcd & 0x0F);
+}
+
+uint8_t bin_to_bcd(uint8_t bin)
+{
+    return ((bin / 10) << 4) | (bin % 10);
+}
+
+/*--------------------------------------------------------------------------------
+  DS3231 time of day, seconds, minutes and hours registers from 0 (24 hour mode)
+--------------------------------------------------------------------------------*/
+bool rtc_read(uint32_t &seconds)
+{
+    Wire.beginTransmission(DS3231_ADDR);
+    Wire.write(0);
+    if (Wire.endTransmission() != 0 || Wire.requestFrom(DS3231_ADDR, uint8_t(3)) != 3)
+    {
+        return false;
+    }
+
+    uint8_t s = bcd_to_bin(Wire.read() & 0x7F);
+    uint8_t m = bcd_to_bin(Wire.read() & 0x7F);
+    uint8_t h = bcd_to_bin(Wire.read() & 0x3F);
+    uint32_t time = h * 3600UL + m * 60UL + s;
+    if (time >= SECONDS_PER_DAY) //a glitch, keep the time we have
+    {
+        return false;
+    }
+    seconds = time;
+    return true;
+}
+
+void rtc_write(uint32_t seconds)
+{
+    Wire.beginTransmission(DS3231_ADDR);
+    Wire.write(0);
+    Wire.write(bin_to_bcd(seconds % 60));
+    Wire.write(bin_to_bcd((seconds / 60) % 60));
+    Wire.write(bin_to_bcd(seconds / 3600));
+    Wire.endTransmission();
+}
+
+Cue schedule_cue(uint8_t index)
+{
+    Cue cue;
+    EEPROM.get(EEPROM_CUES_ADDR + sizeof(CueTableHeader) + index * sizeof(Cue), cue);
+    return cue;
+}
+
+void show_apply(const Cue &cue)
+{
+    showMode = (cue.mode < NUM_SHOW_MODES) ? cue.mode : SHOW_NORMAL;
+    layers[LAYER_SPARKLE].opacity = SHOW_SPARKLE_OPACITY[showMode];
+    layers[LAYER_GLOW].opacity = SHOW_GLOW_OPACITY[showMode];
+    FastLED.setBrightness(cue.brightness);
+    framesPerSecond = (cue.fps > 0) ? cue.fps : UPDATES_PER_SECOND;
+
+    debugSerial.print("show mode ");
+    debugSerial.print(showMode);
+    debugSerial.print(", brightness ");
+    debugSerial.print(cue.brightness);
+    debugSerial.print(", fps ");
+    debugSerial.println(framesPerSecond);
+}
+
+void schedule_point_at(uint8_t index)
+{
+    isNextCueTomorrow = (index >= numCues);
+    nextCue = isNextCueTomorrow ? 0 : index;
+    nextCueSeconds = schedule_cue(nextCue).minute * 60UL;
+}
+
+/*--------------------------------------------------------------------------------
+  Applies the cue in force at the current time, the last one of yesterday if none has
+  come due today, and points at the one after it. Only done when the clock or the cue
+  table changes.
+--------------------------------------------------------------------------------*/
+void schedule_resync()
+{
+    if (!isClockSet || numCues == 0)
+    {
+        return;
+    }
+
+    uint8_t current = numCues - 1;
+
+    for (uint8_t i = 0; i < numCues && schedule_cue(i).minute * 60UL <= clockSeconds; i++)
+    {
+        current = i;
+    }
+
+    show_apply(schedule_cue(current));
+    schedule_point_at((schedule_cue(current).minute * 60UL <= clockSeconds) ? current + 1 : 0);
+}
+
+/*--------------------------------------------------------------------------------
+  Reads the cue table header. Called at boot and when a new table has been written.
+--------------------------------------------------------------------------------*/
+void schedule_load()
+{
+    CueTableHeader header;
+    EEPROM.get(EEPROM_CUES_ADDR, header);
+
+    bool isValid = header.magic == CUE_MAGIC && header.len <= CUES_MAX_LEN && header.len % sizeof(Cue) == 0;
+    numCues = isValid ? header.len / sizeof(Cue) : 0;
+
+    if (numCues == 0)
+    {
+        Cue normal = {0, SHOW_NORMAL, 255, 0};
+        show_apply(normal);
+        return;
+    }
+
+    debugSerial.print("cues: ");
+    debugSerial.println(numCues);
+    schedule_resync();
+}
+
+/*--------------------------------------------------------------------------------
+  Sets the time of day, from a serial time frame (see upload.h)
+--------------------------------------------------------------------------------*/
+void schedule_set_clock(uint32_t seconds, uint8_t speed)
+{
+    clockSeconds = seconds % SECONDS_PER_DAY;
+    clockSpeed = max(speed, uint8_t(1));
+    clockMsAcc = 0;
+    clockms = 0;
+    isClockSet = true;
+
+    if (isRtcPresent && clockSpeed == 1)
+    {
+        rtc_write(clockSeconds);
+    }
+    schedule_resync();
+}
+
+/*--------------------------------------------------------------------------------
+  Hour of the day, or of uptime until the clock is set
+--------------------------------------------------------------------------------*/
+uint8_t schedule_hour()
+{
+    return isClockSet ? (clockSeconds / 3600) % 24 : (millis() / 3600000UL) % 24;
+}
+
+/*--------------------------------------------------------------------------------
+  Done once during setup(), after the dist sensor has started the I2C bus
+--------------------------------------------------------------------------------*/
+void schedule_begin()
+{
+    isRtcPresent = rtc_read(clockSeconds);
+    isClockSet = isRtcPresent;
+    rtcResyncCountdown = RTC_RESYNC_SECONDS;
+    clockms = 0;
+
+    Serial.println(isRtcPresent ? "clock from RTC" : "no RTC, waiting for the time over serial");
+    schedule_load();
+}
+
+/*--------------------------------------------------------------------------------
+  Takes the RTC's time. A small step forward is left to the cue comparison. A step
+  back, or across midnight either way, would leave the next cue and the midnight wrap
+  wrong (a day of cues skipped, or all of them firing), so the schedule is searched
+  again.
+--------------------------------------------------------------------------------*/
+void schedule_rtc_resync()
+{
+    uint32_t seconds;
+    if (!rtc_read(seconds))
+    {
+        return;
+    }
+
+    bool isBack = seconds < clockSeconds;                                   //behind, or ahead past midnight
+    bool isBackPastMidnight = seconds - clockSeconds > SECONDS_PER_DAY / 2; //behind, from before midnight
+    clockSeconds = seconds;
+
+    if (isBack || isBackPastMidnight)
+    {
+        schedule_resync();
+    }
+}
+
+/*--------------------------------------------------------------------------------
+  Called once per loop(). Moves the clock on and applies the next cue when it is due.
+--------------------------------------------------------------------------------*/
+void schedule_service()
+{
+    if (!isClockSet)
+    {
+        return;
+    }
+
+    uint32_t dt = clockms;
+    clockms -= dt;
+    clockMsAcc += dt * clockSpeed;
+
+    while (clockMsAcc >= 1000)
+    {
+        clockMsAcc -= 1000;
+        if (++clockSeconds >= SECONDS_PER_DAY)
+        {
+            clockSeconds = 0;
+            isNextCueTomorrow = false;
+        }
+
+        if (isRtcPresent && clockSpeed == 1 && --rtcResyncCountdown == 0) //millis() drifts ~0.1%
+        {
+            rtcResyncCountdown = RTC_RESYNC_SECONDS;
+            schedule_rtc_resync();
+        }
+    }
+
+    if (numCues > 0 && !isNextCueTomorrow && clockSeconds >= nextCueSeconds)
+    {
+        show_apply(schedule_cue(nextCue));
+        schedule_point_at(nextCue + 1);
+    }
+}
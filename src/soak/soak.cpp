@@ -0,0 +1,435 @@
+/*--------------------------------------------------------------------------------
+  Soak test, built only in the soak environment (pio run -e soak -t upload, then
+  pio device monitor). Wraps the sculpture's setup() and loop() from main.cpp and
+  runs them on a bare Mega, no sensor, buttons or strips needed, for SOAK_DAYS
+  simulated days. The sculpture code is unchanged, random visitors come in through
+  inputOverride (see read_console()).
+
+  millis() is made a virtual clock by moving the core's timer0_millis on at the start
+  of each frame delay, from yield(), which delay() calls first inside FastLED.delay(): a
+  random 0 - 2*SOAK_IDLE_SKIP_MS while both strips are idle and nobody is there, one
+  frame to SOAK_BUSY_SKIP_MS during a visit or playback, so the state machines still
+  see frame sized steps when they matter. The delay then ends at once, so a frame
+  costs its work and ~1ms of wall time. It starts SOAK_START_BEFORE_WRAP_MS before
+  the 32 bit wrap and passes it again every 49.7 simulated days, which covers every
+  elapsedMillis, Bounce2's debounce and FastLED's countFPS() and show timing going
+  through it. micros() is left alone and is the wall clock.
+
+  The strips' controllers are given 0 leds, nothing is wired to them, and the budget
+  check adds back the SOAK_SHOW_US per led that show() would take. The sculpture's
+  debug text is turned off, at 9600 baud it would wait on serial inside the frame.
+
+  The show clock is set to SOAK_CLOCK_START, just before midnight, with the
+  SOAK_CUES table written to EEPROM (update only, a rerun writes nothing), so it
+  crosses midnight on the first day and every day after. Each day the playback style
+  and linked playback are moved on, when both strips are idle.
+
+  Random visitors: one every SOAK_VISIT_GAP_MS on average, staying 10s - 1min,
+  wandering between 10cm and 1.2m and pressing buttons, sometimes both at once.
+  Wall time is bound by the busy frames, ~1200 for a visit and its playback at
+  ~2.5ms each: 60 days with a visit every 3 hours is ~25 minutes by that estimate.
+
+  Checked every frame, and printed with the simulated day and time when they fail
+    - play mode and led states in range, idle strips in state 0
+    - no playback lasting over SOAK_PLAYBACK_MAX_MS
+    - millis() and sync_millis() never going backwards
+    - loop() up to its frame delay, plus show(), within the 1000 / framesPerSecond
+      budget
+    - millis() wrapping exactly as often as the simulated time says
+  and once per simulated day
+    - the show clock crossed midnight once and every cue came due once
+    - a report: frames, wall clock frames per second, simulated days per wall minute,
+      wraps, visits, playbacks, worst frame, free RAM
+--------------------------------------------------------------------------------*/
+
+#define setup sculpture_setup
+#define loop sculpture_loop
+#include "../main.cpp"
+#undef setup
+#undef loop
+
+extern volatile unsigned long timer0_millis; //the Arduino core's millis() count
+extern int __heap_start, *__brkval;
+
+const uint8_t SOAK_DAYS = 60;
+const uint32_t SOAK_START_BEFORE_WRAP_MS = 600000UL;  //10 minutes
+const uint32_t SOAK_IDLE_SKIP_MS = 300000UL;          //mean skip per frame while idle
+const uint8_t SOAK_BUSY_SKIP_MS = 100;
+const uint32_t SOAK_VISIT_GAP_MS = 3UL * 3600000UL;   //mean time between visits
+const uint32_t SOAK_PLAYBACK_MAX_MS = 3600000UL;
+const uint32_t SOAK_DAY_MS = 86400000UL;
+const uint8_t SOAK_MAX_REPORTED = 20;                 //failures printed in full
+const uint8_t SOAK_SHOW_US = 30;                      //per led, 24 bits at 800kHz
+const uint32_t SOAK_CLOCK_START = 23UL * 3600 + 55 * 60;
+
+const Cue SOAK_CUES[] = { //every cue changes the show mode, so each one is seen
+    {6 * 60, SHOW_NORMAL, 255, 0},
+    {11 * 60, SHOW_ATTRACT, 255, 0},
+    {14 * 60, SHOW_NORMAL, 192, 0},
+    {22 * 60, SHOW_NIGHT, 64, 50}};
+const uint8_t SOAK_NUM_CUES = sizeof(SOAK_CUES) / sizeof(Cue);
+
+uint64_t soakSimms = 0;           //simulated time since the start
+uint32_t soakStartMillis, soakLastMillis, soakLastSync;
+uint16_t soakWraps = 0;
+uint32_t soakFrames = 0, soakDayFrames = 0;
+uint32_t soakFrameStartus, soakDayStartus, soakWallStartus;
+uint32_t soakWorkus, soakShowus = 0;
+uint32_t soakWorstFrameus = 0;
+uint32_t soakSkipms = 0;          //virtual time for the next frame delay
+bool isSoakInFrame = false;       //the frame delay has not started yet
+uint16_t soakFailures = 0;
+uint16_t soakVisits = 0, soakPlaybacks = 0;
+uint16_t soakDay = 0;
+
+uint32_t soakLastClock;
+uint8_t soakLastShowMode;
+uint8_t soakDayMidnights = 0, soakDayCues = 0;
+
+bool isSoakVisit = false;
+uint32_t soakVisitEndms;          //millis() when the visitor leaves
+uint32_t soakPlaybackStartms[2];
+bool isSoakPlaybackChecked[2];
+
+int soak_free_ram()
+{
+    int top;
+    return int((intptr_t)&top - (__brkval == 0 ? (intptr_t)&__heap_start : (intptr_t)__brkval));
+}
+
+void soak_print_time()
+{
+    uint32_t seconds = (soakSimms % SOAK_DAY_MS) / 1000;
+    Serial.print("day ");
+    Serial.print(soakDay);
+    Serial.print(' ');
+    Serial.print(seconds / 3600);
+    Serial.print(':');
+    Serial.print((seconds / 60) % 60);
+    Serial.print(' ');
+}
+
+void soak_fail(const char *what, long value)
+{
+    soakFailures++;
+    if (soakFailures > SOAK_MAX_REPORTED)
+    {
+        return;
+    }
+    Serial.print("SOAK FAIL ");
+    soak_print_time();
+    Serial.print(what);
+    Serial.print(' ');
+    Serial.println(value);
+}
+
+void soak_add_millis(uint32_t ms)
+{
+    uint8_t oldSREG = SREG;
+    cli();
+    timer0_millis += ms;
+    SREG = oldSREG;
+}
+
+/*--------------------------------------------------------------------------------
+  The core's yield() is weak. delay(1) calls it first thing inside FastLED.delay(),
+  which is where the frame's work ends and its virtual time goes by.
+--------------------------------------------------------------------------------*/
+void yield()
+{
+    if (!isSoakInFrame)
+    {
+        return;
+    }
+    isSoakInFrame = false;
+    soakWorkus = micros() - soakFrameStartus;
+    soak_add_millis(soakSkipms);
+}
+
+void soak_begin()
+{
+    isDebugQuiet = true;
+    for (uint8_t i = 0; i < FastLED.count(); i++)
+    {
+        soakShowus += FastLED[i].size() * uint32_t(SOAK_SHOW_US);
+        FastLED[i].setLeds(FastLED[i].leds(), 0);
+    }
+
+    uint8_t oldSREG = SREG;
+    cli();
+    timer0_millis = 0xFFFFFFFFUL - SOAK_START_BEFORE_WRAP_MS;
+    SREG = oldSREG;
+
+    CueTableHeader header = {sizeof(SOAK_CUES), CUE_MAGIC};
+    EEPROM.put(EEPROM_CUES_ADDR + sizeof(CueTableHeader), SOAK_CUES);
+    EEPROM.put(EEPROM_CUES_ADDR, header);
+    schedule_load();
+    schedule_set_clock(SOAK_CLOCK_START, 1);
+    soakLastClock = clockSeconds;
+    soakLastShowMode = showMode;
+
+    soakStartMillis = soakLastMillis = millis();
+    soakLastSync = sync_millis();
+    soakWallStartus = soakDayStartus = micros();
+    random16_set_seed(analogRead(0));
+    Serial.println("soak test started");
+}
+
+/*--------------------------------------------------------------------------------
+  inputOverride, a random visitor in place of the buttons and dist sensor. Returns
+  true when there is a new distance reading.
+--------------------------------------------------------------------------------*/
+bool soak_read_inputs()
+{
+    button0.update(); //for Bounce2's timing across the wrap, the pins just read high
+    button1.update();
+
+    if (!isSoakVisit)
+    {
+        if (random16() >= 65536UL / (SOAK_VISIT_GAP_MS / SOAK_IDLE_SKIP_MS)) //idle frames skip SOAK_IDLE_SKIP_MS on average
+        {
+            return false;
+        }
+        isSoakVisit = true;
+        soakVisitEndms = millis() + random16(10, 60) * 1000UL;
+        soakVisits++;
+        rangeVal = random16(100, 1200);
+    }
+
+    if (int32_t(millis() - soakVisitEndms) >= 0)
+    {
+        isSoakVisit = false;
+        isUserPresent = false;
+        return true;
+    }
+
+    if (random8() < 24) //a new reading every ~10 frames, like the sensor
+    {
+        rangeVal = constrain(rangeVal + random16(0, 201) - 100, 100, 1200);
+        isUserPresent = rangeVal <= int(presenceRange);
+
+        uint8_t press = random8();
+        if (press < 8)
+        {
+            isButton0Pressed = (strip1playMode == IDLE_MODE);
+        }
+        else if (press < 16)
+        {
+            isButton1Pressed = (strip2playMode == IDLE_MODE);
+        }
+        else if (press < 20) //both at once
+        {
+            isButton0Pressed = (strip1playMode == IDLE_MODE);
+            isButton1Pressed = (strip2playMode == IDLE_MODE);
+        }
+        return true;
+    }
+    return false;
+}
+
+void soak_check_strip(uint8_t strip, unsigned int playMode, int ledState, int brightness)
+{
+    if (playMode != IDLE_MODE && playMode != BUTTON_MODE)
+    {
+        soak_fail("play mode", playMode);
+    }
+    if (ledState < 0 || ledState > 2 || (playMode == IDLE_MODE && ledState != 0))
+    {
+        soak_fail("led state", ledState);
+    }
+    if (brightness < 0 || brightness > 255)
+    {
+        soak_fail("brightness", brightness);
+    }
+
+    if (playMode == IDLE_MODE)
+    {
+        soakPlaybackStartms[strip] = millis();
+        isSoakPlaybackChecked[strip] = false;
+    }
+    else
+    {
+        if (!isSoakPlaybackChecked[strip] && millis() - soakPlaybackStartms[strip] < 1000)
+        {
+            isSoakPlaybackChecked[strip] = true;
+            soakPlaybacks++;
+        }
+        if (millis() - soakPlaybackStartms[strip] > SOAK_PLAYBACK_MAX_MS)
+        {
+            soak_fail("playback stuck, strip", strip + 1);
+            soakPlaybackStartms[strip] = millis(); //once an hour
+        }
+    }
+}
+
+/*--------------------------------------------------------------------------------
+  Counts midnights and cues on the show clock
+--------------------------------------------------------------------------------*/
+void soak_check_clock()
+{
+    if (clockSeconds < soakLastClock)
+    {
+        soakDayMidnights++;
+    }
+    soakLastClock = clockSeconds;
+
+    if (showMode != soakLastShowMode)
+    {
+        soakDayCues++;
+        soakLastShowMode = showMode;
+    }
+}
+
+/*--------------------------------------------------------------------------------
+  The next day's playback style and linked playback, as the console would set them
+--------------------------------------------------------------------------------*/
+void soak_vary_settings()
+{
+    if (strip1playMode != IDLE_MODE || strip2playMode != IDLE_MODE)
+    {
+        return;
+    }
+    playbackStyle = soakDay % 3;
+    isLinkedPlayback = (soakDay / 3) % 2;
+}
+
+void soak_report()
+{
+    uint32_t now = micros();
+    uint32_t dayus = now - soakDayStartus;
+
+    if (soakDayMidnights != 1)
+    {
+        soak_fail("midnights in the day", soakDayMidnights);
+    }
+    if (soakDayCues != SOAK_NUM_CUES)
+    {
+        soak_fail("cues in the day", soakDayCues);
+    }
+
+    Serial.print("soak ");
+    soak_print_time();
+    Serial.print("frames ");
+    Serial.print(soakFrames);
+    Serial.print(", fps ");
+    Serial.print(soakDayFrames * 1000000.0 / dayus, 1);
+    Serial.print(", days/min ");
+    Serial.print(60000000.0 / dayus, 2);
+    Serial.print(", wraps ");
+    Serial.print(soakWraps);
+    Serial.print(", visits ");
+    Serial.print(soakVisits);
+    Serial.print(", playbacks ");
+    Serial.print(soakPlaybacks);
+    Serial.print(", worst frame us ");
+    Serial.print(soakWorstFrameus);
+    Serial.print(", free ram ");
+    Serial.print(soak_free_ram());
+    Serial.print(", failures ");
+    Serial.println(soakFailures);
+
+    soakDayFrames = 0;
+    soakDayStartus = micros();
+    soakWorstFrameus = 0;
+    soakDayMidnights = soakDayCues = 0;
+    soak_vary_settings();
+
+    if (soakDay == SOAK_DAYS)
+    {
+        Serial.print("SOAK DONE, wall minutes ");
+        Serial.print((micros() - soakWallStartus) / 60000000UL);
+        Serial.println(soakFailures == 0 ? ", PASS" : ", FAIL");
+    }
+}
+
+/*--------------------------------------------------------------------------------
+  Called before the sculpture's loop(). Checks the last frame and picks the virtual
+  time for this one's frame delay.
+--------------------------------------------------------------------------------*/
+void soak_service()
+{
+    uint32_t now = millis();
+    uint32_t step = now - soakLastMillis;
+    if (step < soakSkipms)
+    {
+        soak_fail("millis went back by", soakSkipms - step);
+    }
+    if (now < soakLastMillis)
+    {
+        soakWraps++;
+    }
+    soakSimms += step;
+    soakLastMillis = now;
+
+    uint16_t expectedWraps = (soakStartMillis + soakSimms) >> 32;
+    if (soakWraps != expectedWraps)
+    {
+        soak_fail("wraps, expected", expectedWraps);
+        soakWraps = expectedWraps;
+    }
+
+    uint32_t sync = sync_millis();
+    if (int32_t(sync - soakLastSync) < 0)
+    {
+        soak_fail("sync_millis went back by", soakLastSync - sync);
+    }
+    soakLastSync = sync;
+
+    soak_check_strip(0, strip1playMode, strip1activeLedState, strip1brightness);
+    soak_check_strip(1, strip2playMode, strip2activeLedState, strip2brightness);
+    soak_check_clock();
+
+    FastLED.countFPS();
+    soakFrames++;
+    soakDayFrames++;
+
+    if (soakSimms >= uint64_t(soakDay + 1) * SOAK_DAY_MS)
+    {
+        soakDay++;
+        soak_report();
+    }
+
+    bool isBusy = isSoakVisit || strip1playMode != IDLE_MODE || strip2playMode != IDLE_MODE;
+    uint16_t framems = 1000 / framesPerSecond; //a skip under it would leave FastLED.delay() waiting
+    soakSkipms = isBusy ? random16(framems, max(framems, uint16_t(SOAK_BUSY_SKIP_MS)) + 1)
+                        : max(random16(2 * SOAK_IDLE_SKIP_MS / 1000) * 1000UL, uint32_t(framems));
+    isSoakInFrame = true;
+    soakFrameStartus = micros(); //after the report, which waits on serial
+}
+
+/*--------------------------------------------------------------------------------
+  Called after the sculpture's loop(), which ends in its frame delay
+--------------------------------------------------------------------------------*/
+void soak_frame_done()
+{
+    if (isSoakInFrame)
+    {
+        soak_fail("no frame delay", 0);
+        isSoakInFrame = false;
+        soak_add_millis(soakSkipms);
+        return;
+    }
+
+    uint32_t workus = soakWorkus + soakShowus;
+    uint32_t budgetus = 1000UL * (1000 / framesPerSecond); //as FastLED.delay() is given
+    soakWorstFrameus = max(soakWorstFrameus, workus);
+
+    if (workus > budgetus)
+    {
+        soak_fail("frame over budget, us", workus);
+    }
+}
+
+void setup()
+{
+    inputOverride = soak_read_inputs;
+    sculpture_setup();
+    soak_begin();
+}
+
+void loop()
+{
+    soak_service();
+    sculpture_loop();
+    soak_frame_done();
+}
@@ -0,0 +1,64 @@
+/*--------------------------------------------------------------------------------
+  Optional external SPI NOR flash (W25Qxx or similar) for data sets too long for
+  EEPROM, e.g. months of hourly readings. The sculpture only ever reads it. The chip
+  is programmed with an image from scripts/make_spiflash_image.py, which holds one
+  dataset.h style header and data per SPIFLASH_SLOT_SIZE slot.
+
+  Everything goes through spiflash_read(), so it is the only thing to swap for another
+  block device. test/host/spiflash_check.cpp swaps it for an image file to check the
+  decoding and prefetch on a PC.
+--------------------------------------------------------------------------------*/
+
+const uint8_t SPIFLASH_READ = 0x03, SPIFLASH_JEDEC_ID = 0x9F;
+
+SPISettings spiflashSettings(8000000, MSBFIRST, SPI_MODE0);
+bool isSpiflashPresent = false;
+
+void spiflash_select()
+{
+    SPI.beginTransaction(spiflashSettings);
+    digitalWrite(SPIFLASH_CS_PIN, LOW);
+}
+
+void spiflash_deselect()
+{
+    digitalWrite(SPIFLASH_CS_PIN, HIGH);
+    SPI.endTransaction();
+}
+
+void spiflash_read(uint32_t addr, uint8_t *buf, uint16_t len)
+{
+    spiflash_select();
+    SPI.transfer(SPIFLASH_READ);
+    SPI.transfer(uint8_t(addr >> 16));
+    SPI.transfer(uint8_t(addr >> 8));
+    SPI.transfer(uint8_t(addr));
+    for (uint16_t i = 0; i < len; i++)
+    {
+        buf[i] = SPI.transfer(0);
+    }
+    spiflash_deselect();
+}
+
+/*--------------------------------------------------------------------------------
+  Done once during setup(). A missing chip reads back all 0s or all 1s.
+--------------------------------------------------------------------------------*/
+void spiflash_begin()
+{
+    pinMode(SPIFLASH_CS_PIN, OUTPUT);
+    digitalWrite(SPIFLASH_CS_PIN, HIGH);
+    SPI.begin();
+
+    spiflash_select();
+    SPI.transfer(SPIFLASH_JEDEC_ID);
+    uint8_t manufacturer = SPI.transfer(0);
+    spiflash_deselect();
+
+    isSpiflashPresent = (manufacturer != 0x00 && manufacturer != 0xFF);
+
+    if (isSpiflashPresent)
+    {
+        Serial.print("SPI flash found, manufacturer: ");
+        Serial.println(manufacturer, HEX);
+    }
+}
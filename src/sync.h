@@ -0,0 +1,208 @@
+/*--------------------------------------------------------------------------------
+  Sync between the three sculptures over a shared bus on Serial2 (TX2 16, RX2 17), an
+  RS-485 transceiver per sculpture (e.g. MAX485, driver enable on SYNC_DE_PIN) or,
+  for two sculptures, a plain crossed UART link.
+
+  The sculpture with SYNC_MASTER_ID sends its clock once a second. The others lock
+  their animation clock, sync_millis(), to it: a beacon that is a little off nudges
+  the phase half way and the rate by a fraction of the error, so crystal drift is
+  tuned out after a few beacons, and one that is far off (first beacon, master reset)
+  steps the clock. The idle pulse and noise run off sync_millis(), so they stay in
+  step. Without a master, sync_millis() runs free on millis().
+
+  With isSyncMirror set, a button pressed on one sculpture also plays the strip of the
+  same button on the others.
+
+  Frames, 0x5A, type, node (sculpture ID), payload, crc8 over type..payload
+    'S' beacon : master's sync_millis() (uint32, little endian), 8 bytes in all
+    'B' button : button 0 or 1, 5 bytes in all
+  That is 8 bytes/s on the bus. Frames are queued into the TX buffer and the parser
+  takes a byte at a time, so neither ever waits on the bus.
+--------------------------------------------------------------------------------*/
+
+const uint8_t SYNC_SOF = 0x5A;
+const uint8_t SYNC_BEACON = 'S', SYNC_BUTTON = 'B';
+const uint8_t SYNC_FRAME_MAX = 8;
+const uint8_t SYNC_BYTES_PER_FRAME = 16;       //max serial bytes parsed per loop()
+const unsigned int SYNC_BEACON_MS = 1000;
+const uint8_t SYNC_LATENCY_MS = 13;            //8 byte beacon at 9600 baud, plus half a frame until it is parsed
+const int32_t SYNC_STEP_MS = 250;              //errors above this step the clock instead of slewing it
+const int32_t SYNC_MAX_PPM = 5000;
+const unsigned int SYNC_LOST_MS = 5000;        //beacons missing for this long, free run
+
+uint8_t syncFrame[SYNC_FRAME_MAX];
+uint8_t syncFramePos = 0;
+bool isSyncMaster = false, isSyncLocked = false;
+uint32_t syncBaseLocal, syncBaseMaster; //millis() and master clock at the last beacon
+int32_t syncRatePpm = 0;                //how much faster the master's clock runs
+int32_t syncFreeOffset = 0;             //sync_millis() - millis() while not locked
+elapsedMillis syncBeaconms, syncTxms;
+uint8_t syncTxBytes = 0;                //bytes being sent, for the RS-485 driver enable
+
+/*--------------------------------------------------------------------------------
+  Shared animation clock, in ms
+--------------------------------------------------------------------------------*/
+uint32_t sync_millis()
+{
+    if (!isSyncLocked)
+    {
+        return millis() + syncFreeOffset;
+    }
+
+    int32_t elapsed = millis() - syncBaseLocal;
+    return syncBaseMaster + elapsed + elapsed * syncRatePpm / 1000000L;
+}
+
+void sync_begin()
+{
+    Serial2.begin(9600);
+    pinMode(SYNC_DE_PIN, OUTPUT);
+    digitalWrite(SYNC_DE_PIN, LOW); //listen
+    isSyncMaster = (SCULPTURE_ID == SYNC_MASTER_ID);
+}
+
+void sync_send(uint8_t type, const uint8_t *payload, uint8_t len)
+{
+    uint8_t crc = crc8_update(crc8_update(0, type), SCULPTURE_ID);
+
+    if (Serial2.availableForWrite() < len + 4) //never wait for room, drop it
+    {
+        return;
+    }
+
+    digitalWrite(SYNC_DE_PIN, HIGH);
+    Serial2.write(SYNC_SOF);
+    Serial2.write(type);
+    Serial2.write(SCULPTURE_ID);
+    for (uint8_t i = 0; i < len; i++)
+    {
+        crc = crc8_update(crc, payload[i]);
+        Serial2.write(payload[i]);
+    }
+    Serial2.write(crc);
+
+    syncTxBytes += len + 4;
+    syncTxms = 0;
+}
+
+/*--------------------------------------------------------------------------------
+  Called when a button is pressed, for isSyncMirror
+--------------------------------------------------------------------------------*/
+void sync_send_button(uint8_t button)
+{
+    if (isSyncMirror)
+    {
+        sync_send(SYNC_BUTTON, &button, 1);
+    }
+}
+
+void sync_on_beacon(uint32_t master)
+{
+    uint32_t now = millis();
+    uint32_t predicted = sync_millis();
+    master += SYNC_LATENCY_MS;
+
+    int32_t error = master - predicted;
+
+    if (!isSyncLocked || error > SYNC_STEP_MS || error < -SYNC_STEP_MS)
+    {
+        syncBaseMaster = master;
+        debugSerial.println("sync: clock stepped");
+    }
+    else
+    {
+        syncRatePpm = constrain(syncRatePpm + error * 1000000L / SYNC_BEACON_MS / 32, -SYNC_MAX_PPM, SYNC_MAX_PPM); //gentle, beacons jitter by a few ms
+        syncBaseMaster = predicted + error / 2;
+    }
+
+    syncBaseLocal = now;
+    isSyncLocked = true;
+    syncBeaconms = 0;
+}
+
+void sync_handle_frame()
+{
+    if (syncFrame[1] == SYNC_BEACON && !isSyncMaster)
+    {
+        sync_on_beacon(uint32_t(syncFrame[3]) | (uint32_t(syncFrame[4]) << 8) | (uint32_t(syncFrame[5]) << 16) | (uint32_t(syncFrame[6]) << 24));
+    }
+    else if (syncFrame[1] == SYNC_BUTTON && isSyncMirror)
+    {
+        if (syncFrame[3] == 0 && strip1playMode == IDLE_MODE)
+        {
+            isButton0Pressed = true;
+        }
+        else if (syncFrame[3] == 1 && strip2playMode == IDLE_MODE)
+        {
+            isButton1Pressed = true;
+        }
+    }
+}
+
+/*--------------------------------------------------------------------------------
+  Feeds one byte to the parser. A bad byte restarts the search for a frame.
+--------------------------------------------------------------------------------*/
+void sync_parse_byte(uint8_t c)
+{
+    if (syncFramePos == 0 && c != SYNC_SOF)
+    {
+        return;
+    }
+    if (syncFramePos == 1 && c != SYNC_BEACON && c != SYNC_BUTTON)
+    {
+        syncFramePos = 0;
+        sync_parse_byte(c); //may be the start of the next frame
+        return;
+    }
+    syncFrame[syncFramePos++] = c;
+
+    uint8_t len = (syncFrame[1] == SYNC_BEACON) ? 8 : 5;
+
+    if (syncFramePos > 1 && syncFramePos == len)
+    {
+        syncFramePos = 0;
+
+        uint8_t crc = 0;
+        for (uint8_t i = 1; i < len - 1; i++)
+        {
+            crc = crc8_update(crc, syncFrame[i]);
+        }
+        if (crc == syncFrame[len - 1] && syncFrame[2] != SCULPTURE_ID) //RS-485 hears its own frames
+        {
+            sync_handle_frame();
+        }
+    }
+}
+
+/*--------------------------------------------------------------------------------
+  Called once per loop()
+--------------------------------------------------------------------------------*/
+void sync_service()
+{
+    if (syncTxBytes > 0 && syncTxms > syncTxBytes + 2UL) //~1ms per byte at 9600 baud, then release the bus
+    {
+        digitalWrite(SYNC_DE_PIN, LOW);
+        syncTxBytes = 0;
+    }
+
+    if (isSyncMaster && syncBeaconms >= SYNC_BEACON_MS)
+    {
+        syncBeaconms -= SYNC_BEACON_MS;
+        uint32_t now = sync_millis();
+        uint8_t payload[4] = {uint8_t(now), uint8_t(now >> 8), uint8_t(now >> 16), uint8_t(now >> 24)};
+        sync_send(SYNC_BEACON, payload, sizeof(payload));
+    }
+
+    if (isSyncLocked && syncBeaconms > SYNC_LOST_MS)
+    {
+        syncFreeOffset = sync_millis() - millis(); //carry on from where the shared clock had got to
+        isSyncLocked = false;
+        syncRatePpm = 0;
+        debugSerial.println("sync: lost the master");
+    }
+
+    for (uint8_t n = 0; n < SYNC_BYTES_PER_FRAME && Serial2.available() > 0; n++)
+    {
+        sync_parse_byte(Serial2.read());
+    }
+}
@@ -0,0 +1,434 @@
+/*--------------------------------------------------------------------------------
+  Data set upload over serial, while the sculpture keeps animating.
+  Use scripts/upload_dataset.py on the laptop side, scripts/anim_asm.py --upload for
+  animation programs and scripts/upload_cues.py for the show schedule and clock.
+
+  Every frame, in both directions, is
+      0xA5, type, seq, len, payload[len], crc8 over type..payload
+  'B' begin : slot, count, inMin, inMax, outMin, outMax (slot is 1 byte, rest int16)
+  'D' data  : index of first value, then up to 16 int16 values
+  'E' end   : no payload, marks the slot as valid
+  'P' program : offset, then up to 32 bytes of animation program (see animvm.h)
+  'Q' program end : length. 0 erases the stored program and has to come before the
+              'P' frames, the length of what was sent marks it as valid.
+  'U' cues, 'W' cues end : the same for the show schedule (see scheduler.h)
+  'T' time  : seconds since midnight (uint32), clock speed (1 byte, 1 for real time)
+  'A' analytics : offset (uint16), answered with up to 32 bytes of the counters from
+              there after the status (see analytics.h). Offset 0 also saves them to
+              EEPROM, offset 0xFFFF clears them.
+  'R' recorder : offset (uint16), answered the same with the saved black box log,
+              header included (see recorder.h)
+  All int16 and offsets are little endian. The sculpture answers each frame with the
+  same type and seq and a one byte status payload (followed by the data asked for, for
+  'A' and 'R'), but only after its data has reached EEPROM.
+  Values are delta zigzag varint packed on the way in (see dataset.h), so a slot holds
+  around a thousand samples of a smooth series.
+
+  An EEPROM byte write takes ~3.3ms, so only one byte is written per loop() and no
+  more frames are read until the last one is written. The sender just waits for each
+  reply before sending the next frame.
+--------------------------------------------------------------------------------*/
+
+const uint8_t UPLOAD_SOF = 0xA5;
+const uint8_t UPLOAD_BEGIN = 'B', UPLOAD_DATA = 'D', UPLOAD_END = 'E', UPLOAD_PROGRAM = 'P', UPLOAD_PROGRAM_END = 'Q';
+const uint8_t UPLOAD_CUES = 'U', UPLOAD_CUES_END = 'W', UPLOAD_TIME = 'T', UPLOAD_ANALYTICS = 'A', UPLOAD_RECORDER = 'R';
+const uint8_t UPLOAD_OK = 'K', UPLOAD_BAD_CRC = 'C', UPLOAD_BAD_SEQUENCE = 'S', UPLOAD_BAD_RANGE = 'R', UPLOAD_BUSY = 'B';
+const uint8_t UPLOAD_MAX_VALUES = 16;
+const uint8_t UPLOAD_MAX_PAYLOAD = 2 + 2 * UPLOAD_MAX_VALUES;
+const uint8_t UPLOAD_MAX_PACKED = DZV_MAX_BYTES * UPLOAD_MAX_VALUES;
+const uint8_t UPLOAD_BYTES_PER_FRAME = 16; //max serial bytes parsed per loop()
+const uint8_t UPLOAD_MAX_REPLY_DATA = 32;
+const uint16_t UPLOAD_ANALYTICS_CLEAR = 0xFFFF;
+
+const uint8_t UP_WAIT_SOF = 0, UP_TYPE = 1, UP_SEQ = 2, UP_LEN = 3, UP_PAYLOAD = 4, UP_CRC = 5;
+
+uint8_t uploadState = UP_WAIT_SOF;
+uint8_t uploadType, uploadSeq, uploadLen, uploadPos, uploadCrc;
+uint8_t uploadPayload[UPLOAD_MAX_PAYLOAD];
+
+int8_t uploadSlot = -1;            //slot being uploaded, -1 if none
+unsigned int uploadCount, uploadNext; //values expected and index of the next one
+DatasetHeader uploadHeader;        //written with the end frame
+int uploadPrev;                    //last value, for delta encoding
+bool isProgramUploadOpen = false;  //stored program erased, 'P' frames allowed
+bool isCueUploadOpen = false;      //stored cue table erased, 'U' frames allowed
+void (*uploadOnWritten)() = NULL;  //called once the frame's EEPROM writes are done
+
+uint8_t uploadWriteBuf[UPLOAD_MAX_PACKED]; //bytes waiting to be written to EEPROM
+uint8_t uploadWriteLen, uploadWritePos;
+int uploadWriteAddr;
+bool isUploadReplyPending = false;
+uint8_t uploadReplyType, uploadReplySeq, uploadReplyStatus;
+const uint8_t *uploadReplyData; //sent after the status, read when the reply goes out
+uint8_t uploadReplyDataLen = 0;
+uint8_t uploadReplyBuf[UPLOAD_MAX_REPLY_DATA]; //reply data read from EEPROM
+
+int16_t upload_get_int16(uint8_t index)
+{
+    return int16_t(uploadPayload[index] | (uploadPayload[index + 1] << 8));
+}
+
+void upload_send_reply(uint8_t type, uint8_t seq, uint8_t status, const uint8_t *data, uint8_t dataLen)
+{
+    uint8_t crc = crc8_update(crc8_update(crc8_update(crc8_update(0, type), seq), 1 + dataLen), status);
+
+    Serial.write(UPLOAD_SOF);
+    Serial.write(type);
+    Serial.write(seq);
+    Serial.write(uint8_t(1 + dataLen));
+    Serial.write(status);
+    for (uint8_t i = 0; i < dataLen; i++)
+    {
+        crc = crc8_update(crc, data[i]);
+        Serial.write(data[i]);
+    }
+    Serial.write(crc);
+}
+
+/*--------------------------------------------------------------------------------
+  Queues bytes for EEPROM. The reply goes out once they have all been written.
+--------------------------------------------------------------------------------*/
+void upload_queue_write(int addr, const uint8_t *data, uint8_t len)
+{
+    memcpy(uploadWriteBuf, data, len);
+    uploadWriteLen = len;
+    uploadWritePos = 0;
+    uploadWriteAddr = addr;
+}
+
+bool upload_is_slot_playing(uint8_t slot)
+{
+    if (slot == 0)
+    {
+        return strip1playMode == BUTTON_MODE && strip1data.source == SRC_EEPROM;
+    }
+    return strip2playMode == BUTTON_MODE && strip2data.source == SRC_EEPROM;
+}
+
+bool upload_is_program_playing()
+{
+    return (strip1playMode == BUTTON_MODE && strip1vm.source == SRC_EEPROM && playbackStyle == PLAYBACK_PROGRAM) ||
+           (strip2playMode == BUTTON_MODE && strip2vm.source == SRC_EEPROM && playbackStyle == PLAYBACK_PROGRAM);
+}
+
+/*--------------------------------------------------------------------------------
+  Animation programs and cue tables are stored the same way, a ProgramHeader or
+  CueTableHeader ({len, magic}, 3 bytes) followed by len bytes. The end frame with
+  length 0 erases the stored one and opens the area for part frames, the end frame
+  with the length of what was sent writes the header, magic last.
+--------------------------------------------------------------------------------*/
+const uint8_t STORED_HEADER_SIZE = 3;
+
+uint8_t upload_area_part(int addr, int maxLen, bool isOpen)
+{
+    if (!isOpen || uploadLen < 3)
+    {
+        return UPLOAD_BAD_SEQUENCE;
+    }
+
+    unsigned int offset = uint16_t(upload_get_int16(0));
+    uint8_t len = uploadLen - 2;
+
+    if (long(offset) + len > maxLen)
+    {
+        return UPLOAD_BAD_RANGE;
+    }
+
+    upload_queue_write(addr + STORED_HEADER_SIZE + offset, uploadPayload + 2, len);
+    return UPLOAD_OK;
+}
+
+uint8_t upload_area_end(int addr, int maxLen, uint8_t magic, bool &isOpen, bool isBusy)
+{
+    if (uploadLen != 2)
+    {
+        return UPLOAD_BAD_RANGE;
+    }
+
+    uint16_t len = uint16_t(upload_get_int16(0));
+    uint8_t header[STORED_HEADER_SIZE] = {uint8_t(len), uint8_t(len >> 8), magic};
+
+    if (len > maxLen)
+    {
+        return UPLOAD_BAD_RANGE;
+    }
+    if (isBusy)
+    {
+        return UPLOAD_BUSY;
+    }
+
+    if (len == 0)
+    {
+        const uint8_t invalid = 0xFF;
+        upload_queue_write(addr + STORED_HEADER_SIZE - 1, &invalid, 1);
+        isOpen = true;
+        return UPLOAD_OK;
+    }
+    if (!isOpen)
+    {
+        return UPLOAD_BAD_SEQUENCE;
+    }
+
+    upload_queue_write(addr, header, STORED_HEADER_SIZE); //magic is the last byte written
+    isOpen = false;
+    Serial.print("stored bytes: ");
+    Serial.println(len);
+    return UPLOAD_OK;
+}
+
+uint8_t upload_handle_frame()
+{
+    if (uploadType == UPLOAD_BEGIN)
+    {
+        if (uploadLen != 11)
+        {
+            return UPLOAD_BAD_RANGE;
+        }
+
+        uint8_t slot = uploadPayload[0];
+        uploadHeader.format = FORMAT_DZV;
+        uploadHeader.count = uint16_t(upload_get_int16(1));
+        uploadHeader.size = 0;
+        uploadHeader.inMin = upload_get_int16(3);
+        uploadHeader.inMax = upload_get_int16(5);
+        uploadHeader.outMin = upload_get_int16(7);
+        uploadHeader.outMax = upload_get_int16(9);
+        uploadHeader.magic = DATASET_MAGIC;
+
+        if (slot > 1 || uploadHeader.count == 0 || uploadHeader.inMin == uploadHeader.inMax)
+        {
+            return UPLOAD_BAD_RANGE;
+        }
+        if (upload_is_slot_playing(slot))
+        {
+            return UPLOAD_BUSY;
+        }
+
+        uploadSlot = slot;
+        uploadCount = uploadHeader.count;
+        uploadNext = 0;
+        uploadPrev = 0;
+
+        const uint8_t invalid = 0xFF;
+        upload_queue_write(dataset_slot_addr(slot) + offsetof(DatasetHeader, magic), &invalid, 1); //not valid until the end frame
+        return UPLOAD_OK;
+    }
+    else if (uploadType == UPLOAD_DATA)
+    {
+        if (uploadSlot < 0 || uploadLen < 4 || (uploadLen & 1) != 0)
+        {
+            return UPLOAD_BAD_SEQUENCE;
+        }
+
+        unsigned int index = uint16_t(upload_get_int16(0));
+        uint8_t numValues = (uploadLen - 2) / 2;
+
+        if (index != uploadNext) //lost a frame, sender should resend from uploadNext
+        {
+            return UPLOAD_BAD_SEQUENCE;
+        }
+        if (index + numValues > uploadCount)
+        {
+            return UPLOAD_BAD_RANGE;
+        }
+
+        uint8_t packed[UPLOAD_MAX_PACKED];
+        uint8_t packedLen = 0;
+        int prev = uploadPrev;
+
+        for (uint8_t i = 0; i < numValues; i++)
+        {
+            packedLen += dzv_encode(upload_get_int16(2 + 2 * i), prev, packed + packedLen);
+        }
+        if (uploadHeader.size + packedLen > DATASET_MAX_SIZE) //does not fit in the slot
+        {
+            return UPLOAD_BAD_RANGE;
+        }
+
+        upload_queue_write(dataset_slot_addr(uploadSlot) + sizeof(DatasetHeader) + uploadHeader.size, packed, packedLen);
+        uploadHeader.size += packedLen;
+        uploadPrev = prev;
+        uploadNext += numValues;
+        return UPLOAD_OK;
+    }
+    else if (uploadType == UPLOAD_END)
+    {
+        if (uploadSlot < 0 || uploadNext != uploadCount)
+        {
+            return UPLOAD_BAD_SEQUENCE;
+        }
+
+        upload_queue_write(dataset_slot_addr(uploadSlot), (const uint8_t *)&uploadHeader, sizeof(DatasetHeader)); //magic is the last byte written
+        Serial.print("data set uploaded to slot ");
+        Serial.print(uploadSlot);
+        Serial.print(", bytes: ");
+        Serial.println(uploadHeader.size);
+        uploadSlot = -1;
+        return UPLOAD_OK;
+    }
+    else if (uploadType == UPLOAD_PROGRAM)
+    {
+        return upload_area_part(EEPROM_PROGRAM_ADDR, PROGRAM_MAX_LEN, isProgramUploadOpen);
+    }
+    else if (uploadType == UPLOAD_PROGRAM_END)
+    {
+        return upload_area_end(EEPROM_PROGRAM_ADDR, PROGRAM_MAX_LEN, PROGRAM_MAGIC, isProgramUploadOpen, upload_is_program_playing());
+    }
+    else if (uploadType == UPLOAD_CUES)
+    {
+        return upload_area_part(EEPROM_CUES_ADDR, CUES_MAX_LEN, isCueUploadOpen);
+    }
+    else if (uploadType == UPLOAD_CUES_END)
+    {
+        uint8_t status = upload_area_end(EEPROM_CUES_ADDR, CUES_MAX_LEN, CUE_MAGIC, isCueUploadOpen, false);
+        if (status == UPLOAD_OK)
+        {
+            uploadOnWritten = schedule_load; //table changed or erased
+        }
+        return status;
+    }
+    else if (uploadType == UPLOAD_TIME)
+    {
+        if (uploadLen != 5)
+        {
+            return UPLOAD_BAD_RANGE;
+        }
+
+        uint32_t seconds = uint16_t(upload_get_int16(0)) | (uint32_t(uint16_t(upload_get_int16(2))) << 16);
+        schedule_set_clock(seconds, uploadPayload[4]);
+        return UPLOAD_OK;
+    }
+    else if (uploadType == UPLOAD_ANALYTICS)
+    {
+        if (uploadLen != 2)
+        {
+            return UPLOAD_BAD_RANGE;
+        }
+
+        uint16_t offset = uint16_t(upload_get_int16(0));
+        if (offset == UPLOAD_ANALYTICS_CLEAR)
+        {
+            analytics_clear();
+            analytics_flush();
+            return UPLOAD_OK;
+        }
+        if (offset >= sizeof(analytics))
+        {
+            return UPLOAD_BAD_RANGE;
+        }
+
+        if (offset == 0) //a dump starting, save what it reads
+        {
+            analytics_flush();
+        }
+        uploadReplyData = (const uint8_t *)&analytics + offset;
+        uploadReplyDataLen = min(sizeof(analytics) - offset, size_t(UPLOAD_MAX_REPLY_DATA));
+        return UPLOAD_OK;
+    }
+    else if (uploadType == UPLOAD_RECORDER)
+    {
+        uint16_t offset = uint16_t(upload_get_int16(0));
+        const uint16_t size = REC_HEADER_SIZE + REC_RING_SIZE;
+
+        if (uploadLen != 2 || offset >= size)
+        {
+            return UPLOAD_BAD_RANGE;
+        }
+
+        uploadReplyDataLen = min(size - offset, int(UPLOAD_MAX_REPLY_DATA));
+        for (uint8_t i = 0; i < uploadReplyDataLen; i++)
+        {
+            uploadReplyBuf[i] = EEPROM.read(EEPROM_RECORDER_ADDR + offset + i);
+        }
+        uploadReplyData = uploadReplyBuf;
+        return UPLOAD_OK;
+    }
+    return UPLOAD_BAD_SEQUENCE;
+}
+
+/*--------------------------------------------------------------------------------
+  Called once per loop(). Writes at most one EEPROM byte, otherwise parses at most
+  UPLOAD_BYTES_PER_FRAME bytes of the incoming frame.
+--------------------------------------------------------------------------------*/
+void upload_service()
+{
+    if (uploadWritePos < uploadWriteLen)
+    {
+        EEPROM.update(uploadWriteAddr + uploadWritePos, uploadWriteBuf[uploadWritePos]);
+        uploadWritePos++;
+        return;
+    }
+    if (isUploadReplyPending)
+    {
+        if (uploadOnWritten != NULL)
+        {
+            uploadOnWritten();
+            uploadOnWritten = NULL;
+        }
+        upload_send_reply(uploadReplyType, uploadReplySeq, uploadReplyStatus, uploadReplyData, uploadReplyDataLen);
+        uploadReplyDataLen = 0;
+        isUploadReplyPending = false;
+    }
+
+    for (uint8_t n = 0; n < UPLOAD_BYTES_PER_FRAME && Serial.available() > 0; n++)
+    {
+        uint8_t c = Serial.read();
+
+        if (uploadState == UP_WAIT_SOF)
+        {
+            if (c == UPLOAD_SOF)
+            {
+                uploadState = UP_TYPE;
+                uploadCrc = 0;
+            }
+            else
+            {
+                console_parse_byte(c); //text between frames is for the tuning console
+            }
+        }
+        else if (uploadState == UP_TYPE)
+        {
+            uploadType = c;
+            uploadCrc = crc8_update(uploadCrc, c);
+            uploadState = UP_SEQ;
+        }
+        else if (uploadState == UP_SEQ)
+        {
+            uploadSeq = c;
+            uploadCrc = crc8_update(uploadCrc, c);
+            uploadState = UP_LEN;
+        }
+        else if (uploadState == UP_LEN)
+        {
+            uploadLen = c;
+            uploadPos = 0;
+            uploadCrc = crc8_update(uploadCrc, c);
+            if (uploadLen > UPLOAD_MAX_PAYLOAD)
+            {
+                uploadState = UP_WAIT_SOF; //garbage, resync on the next SOF
+            }
+            else
+            {
+                uploadState = (uploadLen > 0) ? UP_PAYLOAD : UP_CRC;
+            }
+        }
+        else if (uploadState == UP_PAYLOAD)
+        {
+            uploadPayload[uploadPos++] = c;
+            uploadCrc = crc8_update(uploadCrc, c);
+            if (uploadPos == uploadLen)
+            {
+                uploadState = UP_CRC;
+            }
+        }
+        else //UP_CRC
+        {
+            uploadState = UP_WAIT_SOF;
+            uploadReplyType = uploadType;
+            uploadReplySeq = uploadSeq;
+            uploadReplyStatus = (c == uploadCrc) ? upload_handle_frame() : UPLOAD_BAD_CRC;
+            isUploadReplyPending = true;
+            return; //reply after the EEPROM writes are done
+        }
+    }
+}
@@ -0,0 +1,103 @@
+/*--------------------------------------------------------------------------------
+  Frame dump for scripts/led_viewer.py, switched on and off from the tuning console
+  with "view on" and "view off". A frame is copied just before FastLED.show() as
+      0xA5, 'V', frame (uint16), millis() (uint32), frame us (uint16),
+      framesPerSecond, brightness, number of data pins, leds per pin,
+      r g b of every led, pin by pin as added in the profile (leds0..leds3),
+      crc8 of everything after the 0xA5
+  and goes out on the debug port over the next loops, only as far as the TX buffer
+  has room beyond VIEW_TX_SPARE, so loop() never waits on it. Frames rendered while
+  one is going out are skipped, the frame number counts every loop() so the viewer
+  sees the gaps. A CO2 sculpture frame is ~410 bytes, so about 2 frames a second get
+  through at 9600 baud, while the sculpture runs and is timed as usual.
+
+  Frame us is loop() up to the copy, so what the frame cost to work out. The viewer
+  draws it against the 1000000 / framesPerSecond budget. Debug text is off while
+  viewing (see debug.h), a console reply corrupts the frame going out and the viewer
+  drops it on the crc.
+--------------------------------------------------------------------------------*/
+
+const uint8_t VIEW_SOF = 0xA5, VIEW_TYPE = 'V';
+const uint8_t VIEW_HEADER_MAX = 17;   //SOF to the leds per pin, for 4 pins
+const uint8_t VIEW_TX_SPARE = 40;     //left free for console replies, CONSOLE_REPLY_MAX
+
+uint16_t viewFrame = 0;
+unsigned long viewFrameStartus;
+uint8_t viewBuf[VIEW_HEADER_MAX + 3 * MAX_PIXELS + 1]; //the frame going out
+uint16_t viewLen = 0, viewPos = 0;
+
+/*--------------------------------------------------------------------------------
+  Called at the top of loop()
+--------------------------------------------------------------------------------*/
+void view_frame_begin()
+{
+    viewFrameStartus = micros();
+}
+
+void view_put(uint8_t c)
+{
+    viewBuf[viewLen++] = c;
+}
+
+void view_put_u16(uint16_t value)
+{
+    view_put(value);
+    view_put(value >> 8);
+}
+
+void view_copy_frame()
+{
+    unsigned long frameus = min(micros() - viewFrameStartus, 0xFFFFUL);
+    uint32_t now = millis();
+    uint8_t pins = FastLED.count();
+
+    viewLen = viewPos = 0;
+    view_put(VIEW_SOF);
+    view_put(VIEW_TYPE);
+    view_put_u16(viewFrame);
+    view_put_u16(now);
+    view_put_u16(now >> 16);
+    view_put_u16(frameus);
+    view_put(framesPerSecond);
+    view_put(FastLED.getBrightness());
+    view_put(pins);
+    for (uint8_t i = 0; i < pins; i++)
+    {
+        view_put(FastLED[i].size());
+    }
+    for (uint8_t i = 0; i < pins; i++)
+    {
+        memcpy(viewBuf + viewLen, FastLED[i].leds(), 3 * FastLED[i].size());
+        viewLen += 3 * FastLED[i].size();
+    }
+
+    uint8_t crc = 0;
+    for (uint16_t i = 1; i < viewLen; i++)
+    {
+        crc = crc8_update(crc, viewBuf[i]);
+    }
+    view_put(crc);
+}
+
+/*--------------------------------------------------------------------------------
+  Called once per loop(), just before FastLED.show()
+--------------------------------------------------------------------------------*/
+void view_service()
+{
+    if (!isViewing)
+    {
+        viewLen = viewPos = 0;
+        return;
+    }
+
+    if (viewPos == viewLen) //the last one has gone, send this one
+    {
+        view_copy_frame();
+    }
+    viewFrame++;
+
+    for (int room = Serial.availableForWrite() - VIEW_TX_SPARE; room > 0 && viewPos < viewLen; room--)
+    {
+        Serial.write(viewBuf[viewPos++]);
+    }
+}
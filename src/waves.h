@@ -0,0 +1,128 @@
+/*--------------------------------------------------------------------------------
+  Travelling wave playback (playbackStyle PLAYBACK_WAVES). Each reading launches a
+  pulse from the start of the strip in the palette colour of its level. Higher
+  readings travel faster and wider. The current reading stays visible as a dim
+  background under the pulses.
+
+  A pulse's head is a phase accumulator in 1/256 pixels, advanced by its speed for
+  every 8ms since the last frame (a shift and a mask, no divide), so pulses keep their
+  speed whatever the frame rate (the show schedule can lower it). Its shape is a
+  quadwave8 bump whose phase is stepped pixel by pixel from tail to head, so drawing
+  a pixel is a quadwave8, a scale and an add, and only the pixels under a pulse are
+  touched.
+--------------------------------------------------------------------------------*/
+
+const uint8_t WAVE_MAX_PULSES = 4;   //per strip, a new pulse replaces the oldest
+const uint8_t WAVE_SPEED_SHIFT = 3;  //speeds are per 8ms
+const uint8_t WAVE_MIN_SPEED = 10;   //pixels x 256 per 8ms, ~5 pixels/s
+const uint8_t WAVE_MAX_STEP_MS = 100; //a late frame moves the pulses no further than this
+const uint8_t WAVE_MIN_WIDTH = 3;    //pixels
+const uint8_t WAVE_BACKGROUND = 64;  //background brightness, out of 255 of the reading's
+
+struct WavePulse
+{
+    uint16_t head;  //pixels x 256
+    uint8_t speed;  //pixels x 256 per 8ms
+    uint8_t frac;   //of speed x ms not yet a whole 8ms
+    uint8_t width;  //pixels, 0 when unused
+    uint8_t step;   //quadwave8 phase per pixel
+    uint8_t level;  //of the reading that launched it
+};
+
+struct WaveTrain
+{
+    WavePulse pulses[WAVE_MAX_PULSES];
+    uint8_t next;
+    uint32_t lastms; //millis() of the last draw
+};
+
+WaveTrain strip1waves, strip2waves;
+
+void wave_clear(WaveTrain &train)
+{
+    for (uint8_t i = 0; i < WAVE_MAX_PULSES; i++)
+    {
+        train.pulses[i].width = 0;
+    }
+    train.next = 0;
+    train.lastms = millis();
+}
+
+void wave_launch(WaveTrain &train, uint8_t level)
+{
+    WavePulse &pulse = train.pulses[train.next];
+
+    train.next = (train.next + 1) % WAVE_MAX_PULSES;
+
+    pulse.head = 0;
+    pulse.frac = 0;
+    pulse.speed = WAVE_MIN_SPEED + scale8(level, 51); //up to ~30 pixels/s
+    pulse.width = WAVE_MIN_WIDTH + (level >> 5); //up to 10 pixels
+    pulse.step = 255 / pulse.width;
+    pulse.level = level;
+}
+
+/*--------------------------------------------------------------------------------
+  Draws the background at level and moves every pulse on by the time since the last
+  frame
+--------------------------------------------------------------------------------*/
+void wave_draw(WaveTrain &train, CRGB *leds, int numLeds, uint8_t level)
+{
+    uint32_t now = millis();
+    uint8_t dt = min(now - train.lastms, uint32_t(WAVE_MAX_STEP_MS));
+    train.lastms = now;
+
+    CRGB background = palette_colour(level);
+    background.nscale8_video(scale8(level, WAVE_BACKGROUND));
+    blend_fill(leds, numLeds, background);
+
+    uint8_t mode = layerMode;
+    layerMode = BLEND_ADD; //pulses add onto the background
+
+    for (uint8_t i = 0; i < WAVE_MAX_PULSES; i++)
+    {
+        WavePulse &pulse = train.pulses[i];
+
+        if (pulse.width == 0)
+        {
+            continue;
+        }
+
+        uint16_t advance = uint16_t(pulse.speed) * dt + pulse.frac;
+        pulse.head += advance >> WAVE_SPEED_SHIFT;
+        pulse.frac = advance & ((1 << WAVE_SPEED_SHIFT) - 1);
+
+        int head = pulse.head >> 8;
+        int tail = head - pulse.width;
+
+        if (tail >= numLeds) //gone off the end
+        {
+            pulse.width = 0;
+            continue;
+        }
+
+        CRGB colour = palette_colour(pulse.level);
+        colour.nscale8_video(pulse.level);
+        colour = blend_prescale(colour);
+
+        //phase of the first pixel after the tail, less the part of a pixel the head has moved past it
+        uint8_t phase = pulse.step - scale8(pulse.step, pulse.head & 0xFF);
+        int start = tail + 1;
+
+        if (start < 0)
+        {
+            phase += pulse.step * -start;
+            start = 0;
+        }
+
+        for (int j = start; j <= head && j < numLeds; j++)
+        {
+            CRGB pixel = colour;
+            pixel.nscale8_video(quadwave8(phase));
+            blend_scaled_pixel(leds[j], pixel);
+            phase += pulse.step;
+        }
+    }
+
+    layerMode = mode;
+}
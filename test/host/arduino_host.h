@@ -0,0 +1,170 @@
+/*--------------------------------------------------------------------------------
+  Just enough of the Arduino core to compile the sculpture's headers on a PC, for the
+  checks in this directory. Each check includes this, defines what its headers take
+  from main.cpp and the headers before them, then includes the ones it checks.
+
+  millis() is hostMillis, moved on by the check. EEPROM is a 4 KB array counting the
+  writes to every byte. Serial prints to stdout.
+
+  AVR lays structs out with no padding and int is 16 bits. Structs here are packed
+  to match, since EEPROM and flash layouts depend on it. int stays 32 bits, so the
+  checks keep to values that fit in 16.
+--------------------------------------------------------------------------------*/
+
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define PROGMEM
+#define F(s) (s)
+#define pgm_read_byte(p) (*(const uint8_t *)(p))
+#define pgm_read_ptr(p) (*(void *const *)(p))
+#define memcpy_P memcpy
+#define min(a, b) ((a) < (b) ? (a) : (b))
+#define max(a, b) ((a) > (b) ? (a) : (b))
+#define constrain(x, lo, hi) ((x) < (lo) ? (lo) : ((x) > (hi) ? (hi) : (x)))
+#define DEC 10
+#define HEX 16
+
+long map(long x, long inMin, long inMax, long outMin, long outMax)
+{
+    return (x - inMin) * (outMax - outMin) / (inMax - inMin) + outMin;
+}
+
+uint32_t hostMillis = 0;
+
+uint32_t millis()
+{
+    return hostMillis;
+}
+
+uint32_t micros()
+{
+    return hostMillis * 1000;
+}
+
+class elapsedMillis
+{
+public:
+    elapsedMillis() : start(millis()) {}
+    operator uint32_t() const { return millis() - start; }
+    elapsedMillis &operator=(uint32_t ms) { start = millis() - ms; return *this; }
+    elapsedMillis &operator-=(uint32_t ms) { start += ms; return *this; }
+    elapsedMillis &operator+=(uint32_t ms) { start -= ms; return *this; }
+
+private:
+    uint32_t start;
+};
+
+class Print
+{
+public:
+    virtual size_t write(uint8_t c) = 0;
+
+    size_t print(const char *s)
+    {
+        size_t n = 0;
+        while (*s)
+        {
+            n += write(*s++);
+        }
+        return n;
+    }
+    size_t print(char c) { return write(c); }
+    size_t print(long value, int base = DEC) { return print_number(value, base); }
+    size_t print(int value, int base = DEC) { return print_number(value, base); }
+    size_t print(unsigned int value, int base = DEC) { return print_number(value, base); }
+    size_t print(unsigned long value, int base = DEC) { return print_number(value, base); }
+    size_t print(uint8_t value, int base = DEC) { return print_number(value, base); }
+    size_t println() { return write('\n'); }
+    template <typename T>
+    size_t println(T value) { return print(value) + println(); }
+    template <typename T>
+    size_t println(T value, int base) { return print(value, base) + println(); }
+
+private:
+    size_t print_number(long value, int base)
+    {
+        char buf[24];
+        snprintf(buf, sizeof(buf), (base == HEX) ? "%lX" : "%ld", value);
+        return print(buf);
+    }
+};
+
+class HostSerial : public Print
+{
+public:
+    size_t write(uint8_t c)
+    {
+        putchar(c);
+        return 1;
+    }
+    int available() { return 0; }
+    int read() { return -1; }
+    int availableForWrite() { return 63; }
+};
+
+HostSerial Serial;
+
+class HostEeprom
+{
+public:
+    uint8_t mem[4096];
+    uint32_t writes[4096];
+
+    HostEeprom()
+    {
+        erase();
+    }
+    void erase()
+    {
+        memset(mem, 0xFF, sizeof(mem));
+        memset(writes, 0, sizeof(writes));
+    }
+    uint16_t length() { return sizeof(mem); }
+    uint8_t read(int addr) { return mem[check(addr)]; }
+    void write(int addr, uint8_t value)
+    {
+        mem[check(addr)] = value;
+        writes[addr]++;
+    }
+    void update(int addr, uint8_t value)
+    {
+        if (read(addr) != value)
+        {
+            write(addr, value);
+        }
+    }
+    template <typename T>
+    T &get(int addr, T &value)
+    {
+        check(addr + sizeof(T) - 1);
+        memcpy(&value, mem + check(addr), sizeof(T));
+        return value;
+    }
+    template <typename T>
+    const T &put(int addr, const T &value)
+    {
+        for (size_t i = 0; i < sizeof(T); i++)
+        {
+            update(addr + i, ((const uint8_t *)&value)[i]);
+        }
+        return value;
+    }
+
+private:
+    int check(int addr)
+    {
+        if (addr < 0 || addr >= int(sizeof(mem)))
+        {
+            printf("EEPROM address out of range: %d\n", addr);
+            exit(1);
+        }
+        return addr;
+    }
+};
+
+HostEeprom EEPROM;
+
+#pragma pack(1)
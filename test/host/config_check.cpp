@@ -0,0 +1,178 @@
+/*--------------------------------------------------------------------------------
+  Checks config.h's record log on a PC against a fake EEPROM: saves going round the
+  slots and wrapping the sequence byte, saves cut off at every byte (a brownout), and
+  the move from the layout before the log.
+
+      g++ -std=gnu++11 -Wall -o /tmp/config_check test/host/config_check.cpp && /tmp/config_check
+
+  Each boot is config_begin() with the globals as after a reset.
+--------------------------------------------------------------------------------*/
+
+#include "arduino_host.h"
+
+const uint8_t CO2_ID = 1, PM25_ID = 2, VOC_ID = 3;
+const int EEPROM_CONFIG_ADDR = 0x040, EEPROM_CONFIG_SIZE = 0xC0; //as main.cpp
+
+#include "../../src/debug.h"
+#include "../../src/crc8.h"
+#include "../../src/config.h"
+
+const int SAVES = 1000;
+int failures = 0;
+
+void check(bool isOk, const char *what, int n)
+{
+    if (!isOk)
+    {
+        printf("FAILED: %s, %d\n", what, n);
+        failures++;
+    }
+}
+
+void boot()
+{
+    memset(configPayload, 0, sizeof(configPayload));
+    configLen = 0;
+    configSeq = CONFIG_EMPTY;
+    configNextSlot = 0;
+    configWriteStep = configWriteSteps = 0;
+    config_begin();
+}
+
+/*--------------------------------------------------------------------------------
+  A record whose payload depends on n, so every save is different
+--------------------------------------------------------------------------------*/
+void make_payload(int n, uint8_t *payload, uint8_t &len)
+{
+    len = 1 + n % (CONFIG_PAYLOAD_MAX - 1);
+    payload[CONFIG_SCULPTURE_ID] = 1 + n % 3;
+    for (uint8_t i = 1; i < len; i++)
+    {
+        payload[i] = uint8_t(n * 7 + i);
+    }
+}
+
+bool is_payload(const uint8_t *payload, uint8_t len)
+{
+    return configLen == len && memcmp(configPayload, payload, len) == 0;
+}
+
+/*--------------------------------------------------------------------------------
+  Saves a byte per loop() as config_service() does, stopping after steps bytes when
+  steps is not -1. Returns the bytes written.
+--------------------------------------------------------------------------------*/
+int save(int n, int steps)
+{
+    uint8_t len;
+    make_payload(n, configPayload, len);
+    configLen = len;
+    config_save();
+
+    int written = 0;
+    while (configWriteStep < configWriteSteps && written != steps)
+    {
+        config_service();
+        written++;
+    }
+    return written;
+}
+
+void check_rotation()
+{
+    EEPROM.erase();
+    boot();
+    check(configLen == 0, "blank EEPROM has a record", 0);
+
+    for (int n = 0; n < SAVES; n++)
+    {
+        save(n, -1);
+        boot();
+
+        uint8_t payload[CONFIG_PAYLOAD_MAX], len;
+        make_payload(n, payload, len);
+        check(is_payload(payload, len), "boot after a save does not read it back", n);
+        check(configNextSlot == (n + 1) % CONFIG_SLOTS, "save not in the slot after the last", n);
+    }
+
+    uint32_t most = 0;
+    for (int addr = EEPROM_CONFIG_ADDR; addr < EEPROM_CONFIG_ADDR + EEPROM_CONFIG_SIZE; addr++)
+    {
+        most = max(most, EEPROM.writes[addr]);
+    }
+    uint32_t perSlot = (SAVES + CONFIG_SLOTS - 1) / CONFIG_SLOTS;
+    check(most <= 2 * perSlot, "a byte written more than twice per save into its slot", most);
+    printf("rotation: %d saves, at most %u writes to a byte, %u saves per slot\n", SAVES, most, perSlot);
+}
+
+void check_torn_saves()
+{
+    int torn = 0;
+    for (int n = 1; n < 3 * CONFIG_SLOTS; n++)
+    {
+        EEPROM.erase();
+        boot();
+        for (int i = 0; i < n; i++)
+        {
+            save(i, -1);
+        }
+
+        uint8_t payload[CONFIG_PAYLOAD_MAX], len;
+        make_payload(n - 1, payload, len);
+        int steps = save(n, -1);
+
+        for (int cut = 0; cut < steps; cut++)
+        {
+            EEPROM.erase();
+            boot();
+            for (int i = 0; i < n; i++)
+            {
+                save(i, -1);
+            }
+            save(n, cut);
+            boot();
+            check(is_payload(payload, len), "a save cut off does not fall back to the one before", cut);
+            torn++;
+        }
+    }
+    printf("torn saves: %d, all fell back to the record before\n", torn);
+}
+
+void check_legacy()
+{
+    EEPROM.erase();
+    EEPROM.write(CONFIG_LEGACY_PROFILE_ADDR, PM25_ID);
+    uint8_t params[5] = {10, 20, 30, 40, 50};
+    LegacyParamsHeader header = {sizeof(params), 0, CONFIG_LEGACY_PARAMS_MAGIC};
+    for (uint8_t i = 0; i < sizeof(params); i++)
+    {
+        header.crc = crc8_update(header.crc, params[i]);
+        EEPROM.write(CONFIG_LEGACY_PARAMS_ADDR + sizeof(header) + i, params[i]);
+    }
+    EEPROM.put(CONFIG_LEGACY_PARAMS_ADDR, header);
+
+    uint8_t payload[] = {PM25_ID, 10, 20, 30, 40, 50};
+    boot();
+    check(is_payload(payload, sizeof(payload)), "legacy ID and parameters not read", 0);
+    EEPROM.write(CONFIG_LEGACY_PROFILE_ADDR, VOC_ID); //must not be read again
+    boot();
+    check(is_payload(payload, sizeof(payload)), "legacy layout not saved as a record", 0);
+
+    EEPROM.erase();
+    EEPROM.write(CONFIG_LEGACY_PROFILE_ADDR, CO2_ID);
+    header.crc ^= 1;
+    EEPROM.put(CONFIG_LEGACY_PARAMS_ADDR, header);
+    uint8_t idOnly[] = {CO2_ID};
+    boot();
+    check(is_payload(idOnly, sizeof(idOnly)), "legacy parameters with a bad crc not dropped", 0);
+    printf("legacy layout: moved to the log\n");
+}
+
+int main()
+{
+    isViewing = true; //no "config saved" for every save
+    check_rotation();
+    check_torn_saves();
+    check_legacy();
+    printf(failures == 0 ? "ok\n" : "FAILED\n");
+    return failures == 0 ? 0 : 1;
+}
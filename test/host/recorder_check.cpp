@@ -0,0 +1,234 @@
+/*--------------------------------------------------------------------------------
+  Checks recorder.h on a PC against a fake EEPROM: logging until the RAM ring has
+  wrapped several times, saving it, then replaying it.
+
+      g++ -std=gnu++11 -Wall -o /tmp/recorder_check test/host/recorder_check.cpp && /tmp/recorder_check
+
+  Every event logged is also kept here. After the wraps the ring must hold the newest
+  of them, whole, oldest first. The save must copy them to EEPROM as they are, the
+  replay must give back the buttons and readings at the logged intervals, and the mode
+  changes must check as logged.
+--------------------------------------------------------------------------------*/
+
+#include "arduino_host.h"
+
+const int EEPROM_RECORDER_ADDR = 0xC00; //as main.cpp
+const int IDLE_MODE = 1, BUTTON_MODE = 2;
+unsigned int strip1playMode = IDLE_MODE, strip2playMode = IDLE_MODE;
+bool isButton0Pressed, isButton1Pressed, isUserPresent;
+int rangeVal;
+uint16_t presenceRange = 1000;
+
+#include "../../src/debug.h"
+#include "../../src/recorder.h"
+
+const int EVENTS = 2000;
+
+struct Event
+{
+    uint8_t type, arg, reading;
+    uint32_t dt;
+};
+
+Event logged[EVENTS];
+int numLogged = 0;
+uint32_t sinceLogged = 0; //ms since the last event logged
+uint8_t lastReading = REC_NO_RANGE;
+long bytesLogged = 0;
+int failures = 0;
+
+void check(bool isOk, const char *what, int n)
+{
+    if (!isOk)
+    {
+        printf("FAILED: %s, %d\n", what, n);
+        failures++;
+    }
+}
+
+/*--------------------------------------------------------------------------------
+  Logs a random event after a random interval, from a few ms to over the ~35 minutes
+  a 3 byte varint holds
+--------------------------------------------------------------------------------*/
+void log_event(int n)
+{
+    static const uint32_t INTERVALS[] = {3, 100, 127, 128, 5000, 16383, 16384, 600000, 0x1FFFFF, 3000000};
+    uint32_t dt = INTERVALS[rand() % 10];
+    hostMillis += dt;
+    sinceLogged += dt;
+
+    Event &event = logged[numLogged];
+    event.dt = min(sinceLogged, 0x1FFFFFUL);
+    event.reading = 0;
+
+    switch (rand() % 3)
+    {
+    case 0:
+        event.type = REC_BUTTON;
+        event.arg = rand() % 2;
+        rec_log_button(event.arg);
+        break;
+    case 1:
+        event.type = REC_RANGE;
+        rangeVal = (n % 2) ? 8 * (rand() % 200) : 8 * (200 + rand() % 50);
+        event.reading = rangeVal / 8;
+        if (n % 7 == 0)
+        {
+            event.reading = REC_NO_RANGE;
+        }
+        rec_log_range(event.reading != REC_NO_RANGE);
+        if (event.reading == lastReading) //not logged, the same as the last
+        {
+            return;
+        }
+        lastReading = event.reading;
+        break;
+    default:
+        event.type = REC_MODE;
+        event.arg = ((rand() % 2) << 2) | ((rand() % 2) ? BUTTON_MODE : IDLE_MODE);
+        rec_log_mode(event.arg >> 2, event.arg & 3);
+        break;
+    }
+    numLogged++;
+    sinceLogged = 0;
+    bytesLogged += 2 + (event.dt >= 0x80) + (event.dt >= 0x4000) + (event.type == REC_RANGE);
+}
+
+bool is_event(const Event &event, uint8_t type, uint8_t arg, uint32_t dt, uint8_t reading)
+{
+    return event.type == type && event.arg == arg && event.dt == dt && event.reading == reading;
+}
+
+/*--------------------------------------------------------------------------------
+  Returns the index in logged of the oldest event in the ring
+--------------------------------------------------------------------------------*/
+int check_ring()
+{
+    int count = 0;
+    for (uint16_t pos = recTail, used = 0; used < recUsed; count++)
+    {
+        uint8_t len = rec_event_len(pos);
+        pos = (pos + len) % REC_RING_SIZE;
+        used += len;
+    }
+    check(recUsed <= REC_RING_SIZE && recUsed > REC_RING_SIZE - 2 * REC_EVENT_MAX, "ring not full after wrapping", recUsed);
+    check(recHead == (recTail + recUsed) % REC_RING_SIZE, "head, tail and used disagree", recUsed);
+
+    int first = numLogged - count;
+    for (uint16_t pos = recTail, i = first; i < numLogged; i++)
+    {
+        uint8_t type = recRing[pos] >> 4, arg = recRing[pos] & 0x0F;
+        uint32_t dt = 0;
+        uint8_t shift = 0, c, len = rec_event_len(pos);
+        uint16_t p = (pos + 1) % REC_RING_SIZE;
+        do
+        {
+            c = recRing[p];
+            dt |= uint32_t(c & 0x7F) << shift;
+            shift += 7;
+            p = (p + 1) % REC_RING_SIZE;
+        } while (c & 0x80);
+        uint8_t reading = (type == REC_RANGE) ? recRing[p] : 0;
+
+        check(is_event(logged[i], type, arg, dt, reading), "ring event differs from the one logged", i);
+        pos = (pos + len) % REC_RING_SIZE;
+    }
+    check(bytesLogged > 4 * REC_RING_SIZE, "ring wrapped fewer than 4 times", bytesLogged);
+    printf("ring: %d events, %ld bytes logged, the newest %d in %u bytes\n", numLogged, bytesLogged, count, recUsed);
+    return first;
+}
+
+void check_save(int first)
+{
+    rec_save();
+    uint16_t steps = 0;
+    while (isRecSaving)
+    {
+        rec_service();
+        steps++;
+        if (steps == 2) //log calls while saving are dropped
+        {
+            rec_log_button(0);
+        }
+    }
+    check(steps == REC_HEADER_SIZE + recSaveLen + 1, "save not a byte per loop()", steps);
+    check(EEPROM.read(EEPROM_RECORDER_ADDR) == REC_MAGIC, "no magic after the save", 0);
+
+    uint16_t pos = EEPROM_RECORDER_ADDR + REC_HEADER_SIZE, end = pos + recSaveLen;
+    int i = first;
+    while (pos < end)
+    {
+        uint8_t type, arg, reading;
+        uint32_t dt;
+        pos = replay_read_event(pos, type, arg, dt, reading);
+        check(i < numLogged && is_event(logged[i], type, arg, dt, reading), "saved event differs from the one logged", i);
+        i++;
+    }
+    check(i == numLogged, "saved log does not end with the last event", i);
+    printf("save: %u bytes in %u loops\n", recSaveLen, steps);
+}
+
+void check_replay(int first)
+{
+    check(replay_start(), "replay did not start", 0);
+
+    int modes = 0;
+    for (int i = first; i < numLogged; i++)
+    {
+        if (logged[i].type == REC_MODE)
+        {
+            rec_log_mode(logged[i].arg >> 2, logged[i].arg & 3);
+            modes++;
+        }
+    }
+    check(replayModesMatched == modes && replayModesDiffered == 0, "logged mode changes do not check", replayModesDiffered);
+    rec_log_mode(0, BUTTON_MODE); //one more than logged
+    check(replayModesDiffered == 1, "mode change past the log not reported", replayModesDiffered);
+
+    uint32_t due = hostMillis;
+    isButton0Pressed = isButton1Pressed = isReplayRangeDue = false;
+    for (int i = first; i < numLogged; i++) //one event a call, none is logged less than 3ms apart
+    {
+        check(isReplaying, "replay ended before the log", i);
+        due += (i > first) ? logged[i].dt : 0; //the first one's interval is to an event no longer in the log
+        hostMillis = replayNextms;
+        check(hostMillis == due, "replayed event not at the logged interval", i);
+        replay_read_inputs();
+
+        const Event &event = logged[i];
+        bool isButton = (event.arg == 0) ? isButton0Pressed && !isButton1Pressed : isButton1Pressed && !isButton0Pressed;
+        bool isRange = isReplayRangeDue && rangeVal == ((event.reading == REC_NO_RANGE) ? 8190 : event.reading * 8);
+        if (event.type == REC_BUTTON)
+        {
+            check(isButton && !isReplayRangeDue, "replayed button differs from the one logged", i);
+        }
+        else if (event.type == REC_RANGE)
+        {
+            check(isRange && !isButton0Pressed && !isButton1Pressed, "replayed reading differs from the one logged", i);
+        }
+        else
+        {
+            check(!isButton0Pressed && !isButton1Pressed && !isReplayRangeDue, "mode change replayed as an input", i);
+        }
+        isButton0Pressed = isButton1Pressed = isReplayRangeDue = false;
+    }
+    check(!isReplaying, "replay did not end after the log", 0);
+    printf("replay: %d events at the logged intervals, %d mode changes as logged\n", numLogged - first, modes);
+}
+
+int main()
+{
+    isViewing = true; //no debug text for every event
+    srand(1);
+    hostMillis = 1000;
+    for (int n = 0; n < EVENTS; n++)
+    {
+        log_event(n);
+    }
+
+    int first = check_ring();
+    check_save(first);
+    check_replay(first);
+    printf(failures == 0 ? "ok\n" : "FAILED\n");
+    return failures == 0 ? 0 : 1;
+}
@@ -0,0 +1,155 @@
+/*--------------------------------------------------------------------------------
+  Plays an SPI flash image from scripts/make_spiflash_image.py through dataset.h's
+  decoder and prefetch, with the file standing in for the chip behind spiflash_read(),
+  and compares every value with the csv it was built from.
+
+      python3 scripts/make_spiflash_image.py /tmp/spiflash.bin --slot0 datasets/co2_2.csv 0 1800 64 255
+      g++ -std=gnu++11 -Wall -o /tmp/spiflash_check test/host/spiflash_check.cpp
+      /tmp/spiflash_check /tmp/spiflash.bin 0 datasets/co2_2.csv
+
+  The slot is played twice: with dataset_service() once per value, as loop() runs it,
+  which must not underrun, and with it never run, where every chunk underruns and
+  dataset_read_byte() reads it itself. Both must give the csv.
+--------------------------------------------------------------------------------*/
+
+#include "arduino_host.h"
+
+const int EEPROM_DATASET_ADDR = 1024, EEPROM_DATASET_SIZE = 1024; //as main.cpp
+const uint32_t SPIFLASH_SLOT_SIZE = 0x10000;
+
+#include "../../src/debug.h"
+#include "../../src/datasets_generated.h"
+
+struct
+{
+    const FlashDataset *const *catalogue[2];
+    uint8_t catalogueLen[2];
+} profile; //no built in data sets, so the stored one plays
+
+bool isLiveMode = false;
+FlashDataset liveScale;
+
+uint8_t *spiflashImage;
+long spiflashImageSize;
+bool isSpiflashPresent = true;
+unsigned int spiflashReads = 0;
+
+void spiflash_read(uint32_t addr, uint8_t *buf, uint16_t len)
+{
+    for (uint16_t i = 0; i < len; i++, addr++)
+    {
+        buf[i] = (long(addr) < spiflashImageSize) ? spiflashImage[addr] : 0xFF;
+    }
+    spiflashReads++;
+}
+
+#include "../../src/history.h"
+#include "../../src/dataset.h"
+
+/*--------------------------------------------------------------------------------
+  The csv's readings as upload_dataset.py's read_values() takes them, the last column
+  of every line that is a number
+--------------------------------------------------------------------------------*/
+int read_csv(const char *path, int *values, int maxValues)
+{
+    FILE *f = fopen(path, "r");
+    if (f == NULL)
+    {
+        printf("cannot open %s\n", path);
+        exit(1);
+    }
+
+    char line[256];
+    int n = 0;
+    while (fgets(line, sizeof(line), f) != NULL && n < maxValues)
+    {
+        char *field = strrchr(line, ',');
+        field = (field == NULL) ? line : field + 1;
+        char *end;
+        double value = strtod(field, &end);
+        if (end != field && line[0] != '#')
+        {
+            values[n++] = int(value + ((value < 0) ? -0.5 : 0.5));
+        }
+    }
+    fclose(f);
+    return n;
+}
+
+bool play(uint8_t slot, const int *expected, int count, bool isServiced)
+{
+    DataCursor cursor;
+    spiflashUnderruns = 0;
+    spiflashReads = 0;
+    catalogueIndex[slot] = 0;
+    dataset_open(slot, cursor);
+
+    if (cursor.source != SRC_SPIFLASH || int(cursor.len) != count)
+    {
+        printf("slot %d: not played from SPI flash or %d values instead of %d\n", slot, cursor.len, count);
+        return false;
+    }
+
+    for (int i = 0; i < count; i++)
+    {
+        int brightness = dataset_next(cursor);
+        int want = constrain(int(map(expected[i], cursor.inMin, cursor.inMax, cursor.outMin, cursor.outMax)), 0, 255);
+        if (cursor.prev != expected[i] || brightness != want)
+        {
+            printf("value %d: decoded %d brightness %d, csv %d brightness %d\n", i, cursor.prev, brightness, expected[i], want);
+            return false;
+        }
+        if (isServiced)
+        {
+            dataset_service(cursor);
+        }
+    }
+
+    if (!dataset_done(cursor))
+    {
+        printf("not done after %d values\n", count);
+        return false;
+    }
+    if (isServiced && spiflashUnderruns != 0)
+    {
+        printf("%u underruns with dataset_service() every value\n", spiflashUnderruns);
+        return false;
+    }
+
+    printf("%s: %d values, %u chunk reads, %u underruns\n", isServiced ? "serviced" : "unserviced", count, spiflashReads, spiflashUnderruns);
+    return true;
+}
+
+int main(int argc, char **argv)
+{
+    if (argc != 4)
+    {
+        printf("usage: %s image slot csv\n", argv[0]);
+        return 2;
+    }
+
+    FILE *f = fopen(argv[1], "rb");
+    if (f == NULL)
+    {
+        printf("cannot open %s\n", argv[1]);
+        return 1;
+    }
+    fseek(f, 0, SEEK_END);
+    spiflashImageSize = ftell(f);
+    fseek(f, 0, SEEK_SET);
+    spiflashImage = (uint8_t *)malloc(spiflashImageSize);
+    if (fread(spiflashImage, 1, spiflashImageSize, f) != size_t(spiflashImageSize))
+    {
+        printf("cannot read %s\n", argv[1]);
+        return 1;
+    }
+    fclose(f);
+
+    static int expected[0x10000];
+    int count = read_csv(argv[3], expected, 0x10000);
+    uint8_t slot = atoi(argv[2]);
+
+    bool isOk = play(slot, expected, count, true) && play(slot, expected, count, false);
+    printf(isOk ? "ok\n" : "FAILED\n");
+    return isOk ? 0 : 1;
+}